@@ -0,0 +1,91 @@
+
+// includes
+
+#include <iostream>
+#include <string>
+
+#include "bench.hpp"
+#include "common.hpp"
+#include "fen.hpp"
+#include "libmy.hpp"
+#include "pos.hpp"
+#include "search.hpp"
+#include "tt.hpp"
+#include "util.hpp"
+
+// constants
+
+static const int Bench_Size { 20 };
+
+static const std::string Bench_FEN[Bench_Size] { // fixed: the node count is a signature of the search
+   Start_FEN,
+   "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 10",
+   "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 11",
+   "4rrk1/pp1n3p/3q2pQ/2p1pb2/2PP4/2P3N1/P2B2PP/4RRK1 b - - 7 19",
+   "rq3rk1/ppp2ppp/1bnpb3/3N2B1/3NP3/7P/PPPQ1PP1/2KR3R w - - 7 14",
+   "r1bq1r1k/1pp1n1pp/1p1p4/4p2Q/4Pp2/1BNP4/PPP2PPP/3R1RK1 w - - 2 14",
+   "r3r1k1/2p2ppp/p1p1bn2/8/1q2P3/2NPQN2/PPP3PP/R4RK1 b - - 2 15",
+   "r1bbk1nr/pp3p1p/2n5/1N4p1/2Np1B2/8/PPP2PPP/2KR1B1R w kq - 0 13",
+   "r1bq1rk1/ppp1nppp/4n3/3p3Q/3P4/1BP1B3/PP1N2PP/R4RK1 w - - 1 16",
+   "4r1k1/r1q2ppp/ppp2n2/4P3/5Rb1/1N1BQ3/PPP3PP/R5K1 w - - 1 17",
+   "2rqkb1r/ppp2p2/2npb1p1/1N1Nn2p/2P1PP2/8/PP2B1PP/R1BQK2R b KQ - 0 11",
+   "r1bq1r1k/b1p1npp1/p2p3p/1p6/3PP3/1B2NN2/PP3PPP/R2Q1RK1 w - - 1 16",
+   "3r1rk1/p5pp/bpp1pp2/8/q1PP1P2/b3P3/P2NQRPP/1R2B1K1 b - - 6 22",
+   "r1q2rk1/2p1bppp/2Pp4/p6b/Q1PNp3/4B3/PP1R1PPP/2K4R w - - 2 18",
+   "4k2r/1pb2ppp/1p2p3/1R1p4/3P4/2r1PN2/P4PPP/1R4K1 b - - 3 22",
+   "3q2k1/pb3p1p/4pbp1/2r5/PpN2N2/1P2P2P/5PP1/Q2R2K1 b - - 4 26",
+   "6k1/6p1/6Pp/ppp5/3pn2P/1P3K2/1PP2P2/8 b - - 0 1",
+   "6k1/4pp1p/3p2p1/P1pPb3/R7/1r2P1PP/3B1P2/6K1 w - - 0 1",
+   "8/8/8/8/5kp1/P7/8/1K1N4 w - - 0 1",
+   "5k2/7R/4P2p/5K2/p1r2P1p/8/8/8 b - - 0 1",
+};
+
+// functions
+
+void bench(Depth depth) {
+
+   assert(depth > 0 && depth <= Depth_Max);
+
+   Search_Input si;
+   si.depth = depth;
+
+   tt::G_TT.clear(); // same start for every run
+
+   int64 node = 0;
+
+   Timer timer;
+   timer.start();
+
+   for (int i = 0; i < Bench_Size; i++) {
+
+      std::cout << "info string bench position " << (i + 1) << "/" << Bench_Size << " " << Bench_FEN[i] << std::endl;
+
+      Pos pos = pos_from_fen(Bench_FEN[i]);
+
+      Search_Output so;
+      search(so, pos, si);
+
+      node += so.node;
+   }
+
+   timer.stop();
+
+   double time = timer.elapsed();
+   double speed = (time < 0.01) ? 0.0 : double(node) / time;
+
+   std::cout << std::endl;
+   std::cout << "bench depth " << depth << ", " << Bench_Size << " positions" << std::endl;
+   std::cout << "nodes " << node << std::endl; // signature
+   std::cout << "time  " << ml::round(time * 1000.0) << " ms" << std::endl;
+   std::cout << "nps   " << ml::round(speed) << std::endl;
+}
+
+int bench_size() {
+   return Bench_Size;
+}
+
+std::string bench_fen(int i) {
+   assert(i >= 0 && i < Bench_Size);
+   return Bench_FEN[i];
+}
+
@@ -0,0 +1,24 @@
+
+#ifndef BENCH_HPP
+#define BENCH_HPP
+
+// includes
+
+#include <string>
+
+#include "common.hpp"
+#include "libmy.hpp"
+
+// constants
+
+const Depth Bench_Depth { Depth(12) };
+
+// functions
+
+void bench (Depth depth);
+
+int         bench_size ();
+std::string bench_fen  (int i); // also the microbenchmark corpus
+
+#endif // !defined BENCH_HPP
+
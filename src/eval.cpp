@@ -6,6 +6,7 @@
 #include <cstdio>
 #include <cstdlib>
 #include <iostream>
+#include <new>
 #include <string>
 #include <vector>
 
@@ -23,46 +24,10 @@
 
 // constants
 
-const int  Pawn_Table_Bit  { 12 };
-const int  Pawn_Table_Size { 1 << Pawn_Table_Bit };
-const int  Pawn_Table_Mask { Pawn_Table_Size - 1 };
-
 const int  Scale { 100 }; // units per cp
 
 // types
 
-class Score_Pair {
-
-private :
-
-   int64 p_vec;
-
-public :
-
-   Score_Pair ();
-   explicit Score_Pair (int sc);
-   Score_Pair (int mg, int eg);
-
-   void operator += (Score_Pair sp);
-   void operator -= (Score_Pair sp);
-
-   friend Score_Pair operator + (Score_Pair sp);
-   friend Score_Pair operator - (Score_Pair sp);
-
-   friend Score_Pair operator + (Score_Pair s0, Score_Pair s1);
-   friend Score_Pair operator - (Score_Pair s0, Score_Pair s1);
-
-   friend Score_Pair operator * (Score_Pair weight, int n);
-   friend Score_Pair operator * (Score_Pair weight, double x);
-
-   int mg () const;
-   int eg () const;
-
-private :
-
-   static Score_Pair make (int64 vec);
-};
-
 struct Pawn_Info {
    Key key;
    Score_Pair score[Side_Size];
@@ -71,6 +36,12 @@ struct Pawn_Info {
    float centre_file, centre_rank;
 };
 
+struct Pawn_Table { // owned by one thread, so no torn entries
+   Pawn_Info * entry; // cache-line aligned
+   int64 size;
+   ml::Pages pages;
+};
+
 // "constants"
 
 Score_Pair W[] = { // 10000 units = 1 pawn
@@ -837,11 +808,17 @@ Score_Pair W[] = { // 10000 units = 1 pawn
 
 // variables
 
-std::vector<Pawn_Info> G_Pawn_Table;
+static std::vector<Pawn_Table> G_Pawn_Table;
+static int64 G_Pawn_Table_Size { 0 }; // entries
+
+static Score_Pair G_Piece_Square[Side_Size][Piece_Size][Square_Size]; // signed, see init_eval()
 
 // prototypes
 
-static int  eval (const Pos & pos);
+static int  eval (const Pos & pos, Pawn_Table & table, Pawn_Stats * stats);
+
+static void alloc_pawn_table (Pawn_Table & table, int64 size);
+static void free_pawn_table  (Pawn_Table & table);
 
 static void comp_pawn_info (Pawn_Info & pi, const Pos & pos);
 
@@ -855,7 +832,59 @@ static bool pawn_is_unstoppable (const Pos & pos, Square sq, Side sd, const Atta
 
 // functions
 
-void clear_pawn_table() {
+void init_eval() { // material and position weights, for Pos to keep their sum up to date
+
+   for (int s = 0; s < Side_Size; s++) {
+
+      Side sd = side_make(s);
+
+      for (int p = 0; p < Piece_Size; p++) {
+
+         Piece pc = piece_make(p);
+
+         for (int sq = 0; sq < Square_Size; sq++) {
+
+            File fl = square_file(Square(sq));
+            Rank rk = square_rank(Square(sq), sd);
+
+            if (fl >= File_Size / 2) fl = file_opp(fl);
+
+            Score_Pair sc = W[0 + pc] + W[7 + pc * 32 + rk * 4 + fl]; // no material for the king (0)
+            G_Piece_Square[sd][pc][sq] = (sd == White) ? +sc : -sc;
+         }
+      }
+   }
+}
+
+void set_pawn_tables(int threads, int64 bytes) {
+
+   assert(threads > 0);
+
+   int64 size = std::max(bytes / int64(sizeof(Pawn_Info)), int64(1));
+
+   if (size != G_Pawn_Table_Size) {
+
+      for (auto & table : G_Pawn_Table) {
+         free_pawn_table(table);
+      }
+
+      G_Pawn_Table.clear();
+      G_Pawn_Table_Size = size;
+   }
+
+   while (int(G_Pawn_Table.size()) > threads) {
+      free_pawn_table(G_Pawn_Table.back());
+      G_Pawn_Table.pop_back();
+   }
+
+   while (int(G_Pawn_Table.size()) < threads) {
+      Pawn_Table table;
+      alloc_pawn_table(table, size);
+      G_Pawn_Table.push_back(table);
+   }
+}
+
+static void alloc_pawn_table(Pawn_Table & table, int64 size) {
 
    Pawn_Info entry {
       Key(1),
@@ -865,13 +894,31 @@ void clear_pawn_table() {
       0.0, 0.0,
    };
 
-   G_Pawn_Table.clear();
-   G_Pawn_Table.resize(Pawn_Table_Size, entry);
+   void * p = ml::alloc_large(size * int64(sizeof(Pawn_Info)), table.pages);
+
+   table.entry = static_cast<Pawn_Info *>(p);
+   table.size = size;
+
+   for (int64 i = 0; i < size; i++) {
+      new (&table.entry[i]) Pawn_Info(entry);
+   }
+}
+
+static void free_pawn_table(Pawn_Table & table) {
+   ml::free_large(table.entry, table.size * int64(sizeof(Pawn_Info)), table.pages);
+   table.entry = nullptr;
+}
+
+ml::Pages pawn_table_pages() {
+   assert(!G_Pawn_Table.empty());
+   return G_Pawn_Table[0].pages;
 }
 
-Score eval(const Pos & pos, Side sd) {
+Score eval(const Pos & pos, Side sd, int table, Pawn_Stats * stats) {
+
+   assert(table >= 0 && table < int(G_Pawn_Table.size()));
 
-   int sc = eval(pos);
+   int sc = eval(pos, G_Pawn_Table[table], stats);
 
    // drawish?
 
@@ -936,17 +983,21 @@ Score eval(const Pos & pos, Side sd) {
    return score::clamp(score::side(Score(sc), sd)); // for sd
 }
 
-static int eval(const Pos & pos) {
+static int eval(const Pos & pos, Pawn_Table & table, Pawn_Stats * stats) {
 
    Key key = pos.key_pawn();
-   Pawn_Info & entry = G_Pawn_Table[hash::index(key, Pawn_Table_Mask)];
+   Pawn_Info & entry = table.entry[hash::index(key, table.size)];
+
+   if (stats != nullptr) stats->probe += 1;
 
    if (entry.key != key) {
       comp_pawn_info(entry, pos);
       entry.key = key;
+   } else if (stats != nullptr) {
+      stats->hit += 1;
    }
 
-   Pawn_Info pi = entry;
+   const Pawn_Info & pi = entry;
 
    Attack_Info ai;
    ai.init(pos);
@@ -969,17 +1020,7 @@ static int eval(const Pos & pos) {
 
       int var;
 
-      // material
-
-      var = 0;
-
-      for (int p = Pawn; p <= Queen; p++) {
-
-         Piece pc = piece_make(p);
-
-         int mat = pos.count(pc, sd);
-         sc += W[var + pc] * mat;
-      }
+      // material (see Pos::psq())
 
       var = 6;
 
@@ -1082,12 +1123,6 @@ static int eval(const Pos & pos) {
 
          Bit tos = ai.piece_attacks(sq);
 
-         // position
-
-         var = 7 + pc * 32;
-
-         sc += W[var + rk * 4 + fl];
-
          // mobility
 
          var = 199 + pc * 12;
@@ -1249,19 +1284,8 @@ static int eval(const Pos & pos) {
          Square sq = pos.king(sd);
          Piece  pc = King;
 
-         File fl = square_file(sq);
-         Rank rk = square_rank(sq, sd);
-
-         if (fl >= File_Size / 2) fl = file_opp(fl);
-
          Bit tos = ai.piece_attacks(sq);
 
-         // position
-
-         var = 7 + pc * 32;
-
-         sc += W[var + rk * 4 + fl];
-
          // captures
 
          var = 271 + pc * Piece_Size;
@@ -1299,6 +1323,10 @@ static int eval(const Pos & pos) {
       sc = -sc;
    }
 
+   // material and position, updated incrementally
+
+   sc += pos.psq();
+
    // game phase
 
    int stage = pos::stage(pos);
@@ -1326,8 +1354,6 @@ static void comp_pawn_info(Pawn_Info & pi, const Pos & pos) {
 
       // init
 
-      Piece pc = Pawn;
-
       Bit weak_sd = pawn::weak(pos, sd);
 
       // pawn loop
@@ -1341,12 +1367,6 @@ static void comp_pawn_info(Pawn_Info & pi, const Pos & pos) {
 
          if (fl >= File_Size / 2) fl = file_opp(fl);
 
-         // position
-
-         var = 7 + pc * 32;
-
-         sc += W[var + rk * 4 + fl];
-
          // space
 
          var = 646;
@@ -1463,68 +1483,37 @@ static bool pawn_is_unstoppable(const Pos & pos, Square sq, Side sd, const Attac
        || bit::is_incl(fronts, ai.piece_attacks(king_sd)); // protected path
 }
 
-Score piece_mat(Piece pc) {
-
-   assert(pc != Piece_None);
-
-   const int mat[Piece_Size + 1] { 100, 325, 325, 500, 1000, 10000, 0 };
-   return Score(mat[pc]);
-}
-
-Score_Pair::Score_Pair() : Score_Pair(0) {
-}
-
-Score_Pair::Score_Pair(int sc) : Score_Pair(sc, sc) {
-}
-
-Score_Pair::Score_Pair(int mg, int eg) {
-   p_vec = (int64(mg) << 32) + int64(eg); // HACK: "eg"'s sign leaks to "mg"
-}
-
-void Score_Pair::operator+=(Score_Pair sp) {
-   p_vec += sp.p_vec;
+void Pawn_Stats::clear() {
+   probe = 0;
+   hit = 0;
 }
 
-void Score_Pair::operator-=(Score_Pair sp) {
-   p_vec -= sp.p_vec;
+void Pawn_Stats::add(const Pawn_Stats & stats) {
+   probe += stats.probe;
+   hit += stats.hit;
 }
 
-int Score_Pair::mg() const {
-   return p_vec >> 32;
-}
+std::string Pawn_Stats::to_string() const {
 
-int Score_Pair::eg() const {
-   return int(p_vec); // extend sign
-}
+   double hit_rate = (probe == 0) ? 0.0 : double(hit) / double(probe);
 
-Score_Pair Score_Pair::make(int64 vec) {
-   Score_Pair sp;
-   sp.p_vec = vec;
-   return sp;
-}
+   std::string s;
+   s += "probes " + std::to_string(probe);
+   s += " hits " + std::to_string(hit) + " (" + std::to_string(ml::round(hit_rate * 100.0)) + "%)";
 
-Score_Pair operator+(Score_Pair sp) {
-   return Score_Pair::make(+sp.p_vec);
+   return s;
 }
 
-Score_Pair operator-(Score_Pair sp) {
-   return Score_Pair::make(-sp.p_vec);
-}
-
-Score_Pair operator+(Score_Pair s0, Score_Pair s1) {
-   return Score_Pair::make(s0.p_vec + s1.p_vec);
-}
+Score piece_mat(Piece pc) {
 
-Score_Pair operator-(Score_Pair s0, Score_Pair s1) {
-   return Score_Pair::make(s0.p_vec - s1.p_vec);
-}
+   assert(pc != Piece_None);
 
-Score_Pair operator*(Score_Pair weight, int n) {
-   return Score_Pair::make(weight.p_vec * n);
+   const int mat[Piece_Size + 1] { 100, 325, 325, 500, 1000, 10000, 0 };
+   return Score(mat[pc]);
 }
 
-Score_Pair operator*(Score_Pair weight, double x) {
-   return Score_Pair(ml::round(double(weight.mg()) * x),
-                     ml::round(double(weight.eg()) * x));
+Score_Pair piece_square(Piece pc, Side sd, Square sq) {
+   assert(pc != Piece_None);
+   return G_Piece_Square[sd][pc][sq];
 }
 
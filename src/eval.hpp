@@ -4,18 +4,37 @@
 
 // includes
 
+#include <string>
+
 #include "common.hpp"
 #include "libmy.hpp"
+#include "score.hpp"
 
 class Pos;
 
+// types
+
+struct Pawn_Stats { // per thread
+   int64 probe;
+   int64 hit;
+
+   void clear ();
+   void add   (const Pawn_Stats & stats);
+
+   std::string to_string () const;
+};
+
 // functions
 
-void clear_pawn_table ();
+void init_eval ();
+
+void      set_pawn_tables  (int threads, int64 bytes); // one private table per search thread
+ml::Pages pawn_table_pages (); // backing of the main thread's table
 
-Score eval (const Pos & pos, Side sd);
+Score eval (const Pos & pos, Side sd, int table = 0, Pawn_Stats * stats = nullptr);
 
-Score piece_mat (Piece pc);
+Score      piece_mat    (Piece pc);
+Score_Pair piece_square (Piece pc, Side sd, Square sq); // material + position, White's point of view
 
 #endif // !defined EVAL_HPP
 
@@ -138,12 +138,13 @@ Key key_en_passant(File fl) {
    return Key_En_Passant[fl];
 }
 
-int index(Key key, int mask) {
-   return int(key) & mask;
+int64 index(Key key, int64 size) { // [0, size), from the high bits; no power-of-two restriction
+   assert(size > 0);
+   return int64(ml::mul_hi(uint64(key), uint64(size)));
 }
 
-uint32 lock(Key key) {
-   return uint32(uint64(key) >> 32);
+uint32 lock(Key key) { // low bits, independent from index()
+   return uint32(uint64(key));
 }
 
 }
@@ -26,7 +26,7 @@ Key  key_piece      (Piece pc, Side sd, Square sq);
 Key  key_castling   (Side sd, Bit rooks);
 Key  key_en_passant (File fl);
 
-int    index (Key key, int mask);
+int64  index (Key key, int64 size);
 uint32 lock  (Key key);
 
 }
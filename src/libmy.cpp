@@ -15,12 +15,184 @@
 #include <sstream>
 #include <string>
 
+#if defined _WIN32
+#include <malloc.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
 #include "libmy.hpp"
 
 namespace ml {
 
+// constants
+
+const int64 Line_Size      { 64 };
+const int64 Huge_Page_Size { int64(1) << 21 }; // 2 MiB
+
+// prototypes
+
+static void * alloc_aligned (int64 size, int64 align);
+static void   free_aligned  (void * p);
+
 // functions
 
+// memory
+
+void * alloc_large(int64 size, Pages & pages) {
+
+   assert(size > 0);
+
+   void * p = nullptr;
+
+#ifdef __linux__
+
+   if (size >= Huge_Page_Size) {
+
+      // explicit huge pages (needs vm.nr_hugepages)
+
+      int64 huge_size = (size + Huge_Page_Size - 1) & -Huge_Page_Size;
+
+      p = mmap(nullptr, huge_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+
+      if (p != MAP_FAILED) {
+         pages = Pages::Huge;
+         return p;
+      }
+
+      // transparent huge pages: over-allocate, then trim to a 2 MiB boundary
+
+      p = mmap(nullptr, huge_size + Huge_Page_Size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+      if (p != MAP_FAILED) {
+
+         char * begin = static_cast<char *>(p);
+         char * end   = begin + huge_size + Huge_Page_Size;
+
+         char * q = reinterpret_cast<char *>((reinterpret_cast<std::uintptr_t>(begin) + Huge_Page_Size - 1) & ~std::uintptr_t(Huge_Page_Size - 1));
+
+         if (q != begin) munmap(begin, q - begin);
+         if (q + huge_size != end) munmap(q + huge_size, end - (q + huge_size));
+
+         if (madvise(q, huge_size, MADV_HUGEPAGE) == 0) {
+            pages = Pages::Transparent;
+            return q;
+         }
+
+         munmap(q, huge_size);
+      }
+   }
+
+#endif
+
+   p = alloc_aligned(size, Line_Size);
+
+   if (p == nullptr) {
+      std::cerr << "ml::alloc_large(): out of memory" << std::endl;
+      std::exit(EXIT_FAILURE);
+   }
+
+   pages = Pages::Normal;
+   return p;
+}
+
+void free_large(void * p, int64 size, Pages pages) {
+
+   if (p == nullptr) return;
+
+#ifdef __linux__
+
+   if (pages != Pages::Normal) { // mmap
+      int64 huge_size = (size + Huge_Page_Size - 1) & -Huge_Page_Size;
+      munmap(p, huge_size);
+      return;
+   }
+
+#else
+
+   (void) size;
+   (void) pages;
+
+#endif
+
+   free_aligned(p);
+}
+
+std::string pages_to_string(Pages pages) {
+
+   switch (pages) {
+   case Pages::Normal :      return "normal pages";
+   case Pages::Transparent : return "transparent huge pages";
+   case Pages::Huge :        return "huge pages";
+   case Pages::File :        return "file mapping";
+   }
+
+   return "?";
+}
+
+void * map_file(const std::string & file, int64 & size) {
+
+#ifdef _WIN32
+
+   (void) file;
+   (void) size;
+
+   return nullptr; // not supported
+
+#else
+
+   int fd = open(file.c_str(), O_RDONLY);
+   if (fd < 0) return nullptr;
+
+   struct stat st;
+
+   if (fstat(fd, &st) != 0 || st.st_size == 0) {
+      close(fd);
+      return nullptr;
+   }
+
+   size = st.st_size;
+
+   void * p = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+   close(fd); // the mapping keeps the file open
+
+   return (p != MAP_FAILED) ? p : nullptr;
+
+#endif
+}
+
+void unmap_file(void * p, int64 size) {
+
+#ifdef _WIN32
+   (void) p;
+   (void) size;
+#else
+   if (p != nullptr) munmap(p, size);
+#endif
+}
+
+static void * alloc_aligned(int64 size, int64 align) {
+
+#ifdef _WIN32
+   return _aligned_malloc(size, align);
+#else
+   void * p;
+   return (posix_memalign(&p, align, size) == 0) ? p : nullptr;
+#endif
+}
+
+static void free_aligned(void * p) {
+
+#ifdef _WIN32
+   _aligned_free(p);
+#else
+   std::free(p);
+#endif
+}
+
 // math
 
 uint64 rand_int_64() {
@@ -32,6 +32,7 @@
 
 #ifdef _MSC_VER
 #include <intrin.h>
+#include <xmmintrin.h>
 #pragma intrinsic(_BitScanForward64)
 #pragma intrinsic(_BitScanReverse64)
 #  if BMI
@@ -110,10 +111,35 @@ namespace ml {
    };
 }
 
+// types
+
+namespace ml {
+
+   enum class Pages : int { Normal, Transparent, Huge, File }; // backing of a large allocation
+}
+
 // functions
 
 namespace ml {
 
+   // memory
+
+   void * alloc_large (int64 size, Pages & pages); // cache-line aligned, huge pages if possible (then zero-filled)
+   void   free_large  (void * p, int64 size, Pages pages);
+
+   std::string pages_to_string (Pages pages);
+
+   void * map_file   (const std::string & file, int64 & size); // private copy-on-write mapping, paged in lazily
+   void   unmap_file (void * p, int64 size);
+
+#ifdef _MSC_VER
+   inline void prefetch (const void * p) { _mm_prefetch(static_cast<const char *>(p), _MM_HINT_T0); }
+   inline void pause    () { _mm_pause(); }
+#else
+   inline void prefetch (const void * p) { __builtin_prefetch(p); }
+   inline void pause    () { __builtin_ia32_pause(); } // spin-wait hint
+#endif
+
    // math
 
    uint64 rand_int_64 ();
@@ -137,6 +163,8 @@ namespace ml {
 
    inline int bit_first (uint64 b) { assert(b != 0); unsigned long i; _BitScanForward64(&i, b); return i; }
    inline int bit_count (uint64 b) { return int(__popcnt64(b)); }
+
+   inline uint64 mul_hi (uint64 a, uint64 b) { return __umulh(a, b); }
 #if BMI
    inline uint64 pext (uint64 a, uint64 b) { return _pext_u64(a, b); }
    inline uint64 pdep (uint64 a, uint64 b) { return _pdep_u64(a, b); }
@@ -146,6 +174,9 @@ namespace ml {
 
    inline int bit_first (uint64 b) { assert(b != 0); return __builtin_ctzll(b); }
    inline int bit_count (uint64 b) { return __builtin_popcountll(b); }
+
+   __extension__ typedef unsigned __int128 uint128;
+   inline uint64 mul_hi (uint64 a, uint64 b) { return uint64((uint128(a) * b) >> 64); }
 #if BMI
    inline uint64 pext (uint64 a, uint64 b) { return __builtin_ia32_pext_di(a, b); }
    inline uint64 pdep (uint64 a, uint64 b) { return __builtin_ia32_pdep_di(a, b); }
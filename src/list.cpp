@@ -36,29 +36,35 @@ void List::add(Move mv, int sc) {
    p_pair.add(Move_Score(mv, sc));
 }
 
-void List::set_size(int size) {
-   assert(size <= this->size());
+void List::set_size(int size) { // growing leaves slots for set_move()
+   assert(size >= 0 && size <= Size);
    p_pair.set_size(size);
 }
 
+void List::set_move(int i, Move mv) {
+   assert(i >= 0 && i < size());
+   p_pair[i] = Move_Score(mv);
+}
+
 void List::set_score(int i, int sc) {
    assert(i >= 0 && i < size());
    p_pair[i].set_score(sc);
 }
 
-void List::mtf(int i) {
+void List::mtf(int i, int to) {
 
    assert(i >= 0 && i < size());
+   assert(to >= 0 && to <= i);
 
    // stable "swap"
 
    Move_Score pair = p_pair[i];
 
-   for (int j = i; j > 0; j--) {
+   for (int j = i; j > to; j--) {
       p_pair[j] = p_pair[j - 1];
    }
 
-   p_pair[0] = pair;
+   p_pair[to] = pair;
 }
 
 void List::sort() {
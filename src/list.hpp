@@ -49,9 +49,10 @@ public :
    void add (Move mv, int sc);
 
    void set_size  (int size);
+   void set_move  (int i, Move mv);
    void set_score (int i, int sc);
 
-   void mtf  (int i); // move to front
+   void mtf  (int i, int to = 0); // move to front (position "to")
    void sort ();
 
    int  size  ()      const;
@@ -10,6 +10,7 @@
 #include <string>
 #include <vector>
 
+#include "bench.hpp"
 #include "bit.hpp"
 #include "common.hpp"
 #include "eval.hpp"
@@ -22,6 +23,7 @@
 #include "math.hpp"
 #include "move.hpp"
 #include "pawn.hpp"
+#include "perft.hpp"
 #include "pos.hpp"
 #include "search.hpp"
 #include "sort.hpp"
@@ -39,6 +41,17 @@ const std::string Engine_Version { "2.0" };
 
 static void uci_loop ();
 
+static void disp_perft (const Pos & pos, Depth depth, bool divide);
+
+static Move find_move (const std::string & s, const Pos & pos);
+
+static void init_tables ();
+
+static void set_hash   ();
+static void clear_hash ();
+static void save_hash  ();
+static void load_hash  ();
+
 // functions
 
 int main(int argc, char * argv[]) {
@@ -50,9 +63,37 @@ int main(int argc, char * argv[]) {
    bit::init();
    hash::init();
    pawn::init();
+   init_eval(); // before any Pos
    pos::init();
    var::init();
 
+   if (arg == "bench") { // senpai bench [depth] [threads] [hash], no input listening
+
+      int depth = (argc > 2) ? std::stoi(argv[2]) : int(Bench_Depth);
+
+      if (argc > 3) var::set("Threads", argv[3]);
+      if (argc > 4) var::set("Hash", argv[4]);
+
+      init_tables();
+      bench(Depth(math::clamp(depth, 1, int(Depth_Max))));
+
+      return EXIT_SUCCESS;
+   }
+
+   if (arg == "perft") { // senpai perft [depth] [threads] [hash], move-generator suite
+
+      int depth = (argc > 2) ? std::stoi(argv[2]) : int(Depth_Max);
+
+      if (argc > 3) var::set("Threads", argv[3]);
+      var::update();
+
+      if (argc > 4) set_perft_hash(int64(std::stoi(argv[4])) << 20);
+
+      bool ok = perft_suite(Depth(math::clamp(depth, 1, int(Depth_Max))));
+
+      return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+   }
+
    listen_input();
 
    var::update();
@@ -93,24 +134,28 @@ static void uci_loop() {
          std::cout << "id name " << Engine_Name + " " + Engine_Version << std::endl;
          std::cout << "id author " << "Fabien Letouzey" << std::endl;
 
-         std::cout << "option name " << "Hash" << " type spin default " << var::get("Hash") << " min 1 max 16384" << std::endl;
+         std::cout << "option name " << "Hash" << " type spin default " << var::get("Hash") << " min 1 max 1048576" << std::endl;
+         std::cout << "option name " << "Hash File" << " type string default " << var::get("Hash File") << std::endl;
+         std::cout << "option name " << "Never Clear Hash" << " type check default " << var::get("Never Clear Hash") << std::endl;
+         std::cout << "option name " << "Hash Stats" << " type check default " << var::get("Hash Stats") << std::endl;
+         std::cout << "option name " << "Pawn Hash" << " type spin default " << var::get("Pawn Hash") << " min 1 max 1024" << std::endl;
          std::cout << "option name " << "Ponder" << " type check default " << var::get("Ponder") << std::endl;
-         std::cout << "option name " << "Threads" << " type spin default " << var::get("Threads") << " min 1 max 16" << std::endl;
+         std::cout << "option name " << "Threads" << " type spin default " << var::get("Threads") << " min 1 max 1024" << std::endl;
+         std::cout << "option name " << "SMP Mode" << " type combo default " << var::get("SMP Mode") << " var YBWC var Lazy" << std::endl;
+         std::cout << "option name " << "Seed History" << " type check default " << var::get("Seed History") << std::endl;
+         std::cout << "option name " << "MultiPV" << " type spin default " << var::get("MultiPV") << " min 1 max 64" << std::endl;
          std::cout << "option name " << "UCI_Chess960" << " type check default " << var::get("UCI_Chess960") << std::endl;
 
          std::cout << "option name " << "Clear Hash" << " type button" << std::endl;
+         std::cout << "option name " << "Save Hash" << " type button" << std::endl;
+         std::cout << "option name " << "Load Hash" << " type button" << std::endl;
 
          std::cout << "uciok" << std::endl;
 
       } else if (command == "isready") {
 
          if (!init_done) {
-
-            var::update();
-
-            clear_pawn_table();
-            tt::G_TT.set_size(int64(var::Hash) << (20 - 4)); // * 1MiB / 16 bytes
-
+            init_tables();
             init_done = true;
          }
 
@@ -157,15 +202,27 @@ static void uci_loop() {
          }
 
          if (name == "Clear Hash") {
-            tt::G_TT.clear();
+            clear_hash();
+         } else if (name == "Save Hash") {
+            save_hash();
+         } else if (name == "Load Hash") {
+            if (!init_done) {
+               init_tables();
+               init_done = true;
+            }
+            load_hash();
          } else {
             var::set(name, value);
             var::update();
+            if (init_done) { // no-ops unless changed
+               set_pawn_tables(var::Threads, int64(var::Pawn_Hash) << 20);
+               set_search_threads(var::Threads);
+            }
          }
 
       } else if (command == "ucinewgame") {
 
-         tt::G_TT.clear();
+         if (!var::Never_Clear_Hash) clear_hash();
 
       } else if (command == "position") {
 
@@ -226,7 +283,14 @@ static void uci_loop() {
 
       } else if (command == "go") {
 
+         if (!init_done) { // GUIs may skip isready
+            init_tables();
+            init_done = true;
+         }
+
          int depth = -1;
+         int64 node = -1;
+         int mate = -1;
          double move_time = -1.0;
 
          bool smart = false;
@@ -236,6 +300,7 @@ static void uci_loop() {
 
          bool ponder = false;
          bool analyze = false;
+         bool search_moves = false;
 
          std::string arg;
 
@@ -245,6 +310,12 @@ static void uci_loop() {
             } else if (arg == "depth") {
                ss >> arg;
                depth = std::stoi(arg);
+            } else if (arg == "nodes") {
+               ss >> arg;
+               node = std::stoll(arg);
+            } else if (arg == "mate") {
+               ss >> arg;
+               mate = std::stoi(arg);
             } else if (arg == "movetime") {
                ss >> arg;
                move_time = std::stod(arg) / 1000.0;
@@ -264,10 +335,17 @@ static void uci_loop() {
                ponder = true;
             } else if (arg == "infinite") {
                analyze = true;
+            } else if (arg == "searchmoves") {
+               search_moves = true;
+            } else if (search_moves) { // until the next keyword
+               Move mv = find_move(arg, game.pos());
+               if (mv != move::None) si.search_moves.add(mv);
             }
          }
 
          if (depth >= 0) si.depth = Depth(depth);
+         if (node >= 1) si.node = node;
+         if (mate >= 1) si.mate = mate;
          if (move_time >= 0.0) si.time = move_time;
 
          if (smart) si.set_time(moves, game_time - inc, inc); // GUIs add the increment only after the move :(
@@ -303,6 +381,40 @@ static void uci_loop() {
 
          // no-op (handled during search)
 
+      } else if (command == "bench") {
+
+         if (!init_done) {
+            init_tables();
+            init_done = true;
+         }
+
+         int depth = Bench_Depth;
+
+         std::string arg;
+         if (ss >> arg) depth = std::stoi(arg);
+
+         bench(Depth(math::clamp(depth, 1, int(Depth_Max))));
+
+      } else if (command == "perft" || command == "divide") { // "perft" alone runs the suite
+
+         int depth = 0;
+         int hash = 0; // MiB
+
+         std::string arg;
+         if (ss >> arg) depth = std::stoi(arg);
+         if (ss >> arg) hash = std::stoi(arg);
+
+         var::update();
+         set_perft_hash(int64(hash) << 20);
+
+         if (depth <= 0) {
+            perft_suite(Depth_Max);
+         } else {
+            disp_perft(game.pos(), Depth(std::min(depth, int(Depth_Max))), command == "divide");
+         }
+
+         set_perft_hash(0);
+
       } else if (command == "quit") {
 
          std::exit(EXIT_SUCCESS);
@@ -310,3 +422,97 @@ static void uci_loop() {
    }
 }
 
+
+static Move find_move(const std::string & s, const Pos & pos) { // legal moves only, unlike move::from_uci()
+
+   List list;
+   gen_legals(list, pos);
+
+   for (int i = 0; i < list.size(); i++) {
+      if (move::to_uci(list[i], pos) == s) return list[i];
+   }
+
+   return move::None;
+}
+
+static void disp_perft(const Pos & pos, Depth depth, bool divide) {
+
+   Timer timer;
+   timer.start();
+
+   int64 node = perft(pos, depth, divide);
+
+   timer.stop();
+
+   double time = timer.elapsed();
+   double speed = (time < 0.01) ? 0.0 : double(node) / time;
+
+   if (divide) std::cout << std::endl;
+   std::cout << "perft depth " << depth << " nodes " << node;
+   std::cout << " time " << ml::round(time * 1000.0) << " ms nps " << ml::round(speed) << std::endl;
+}
+
+static void init_tables() {
+
+   var::update();
+
+   set_pawn_tables(var::Threads, int64(var::Pawn_Hash) << 20);
+   set_search_threads(var::Threads);
+   set_hash();
+
+   std::cout << "info string pawn hash " << var::Pawn_Hash << " MiB per thread, " << ml::pages_to_string(pawn_table_pages()) << std::endl;
+}
+
+static void set_hash() {
+
+   Timer timer;
+   timer.start();
+
+   tt::G_TT.set_size(int64(var::Hash) << 20);
+
+   timer.stop();
+
+   std::cout << "info string hash " << var::Hash << " MiB, " << ml::pages_to_string(tt::G_TT.pages());
+   std::cout << ", set up in " << ml::round(timer.elapsed() * 1000.0) << " ms" << std::endl;
+}
+
+static void clear_hash() {
+
+   Timer timer;
+   timer.start();
+
+   tt::G_TT.clear();
+
+   timer.stop();
+
+   std::cout << "info string hash cleared in " << ml::round(timer.elapsed() * 1000.0) << " ms" << std::endl;
+}
+
+static void save_hash() {
+
+   std::string file = var::get("Hash File");
+
+   Timer timer;
+   timer.start();
+
+   bool ok = tt::G_TT.save(file);
+
+   timer.stop();
+
+   if (ok) {
+      std::cout << "info string hash saved to " << file << " in " << ml::round(timer.elapsed() * 1000.0) << " ms" << std::endl;
+   } else {
+      std::cout << "info string cannot save hash to " << file << std::endl;
+   }
+}
+
+static void load_hash() {
+
+   std::string file = var::get("Hash File");
+
+   if (tt::G_TT.load(file)) {
+      std::cout << "info string hash loaded from " << file << ", " << (tt::G_TT.bytes() >> 20) << " MiB" << std::endl;
+   } else {
+      std::cout << "info string cannot load hash from " << file << std::endl;
+   }
+}
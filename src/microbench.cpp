@@ -0,0 +1,492 @@
+
+// includes
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif
+
+#include "attack.hpp"
+#include "bench.hpp"
+#include "bit.hpp"
+#include "common.hpp"
+#include "eval.hpp"
+#include "fen.hpp"
+#include "gen.hpp"
+#include "hash.hpp"
+#include "libmy.hpp"
+#include "list.hpp"
+#include "math.hpp"
+#include "move.hpp"
+#include "pawn.hpp"
+#include "pos.hpp"
+#include "score.hpp"
+#include "search.hpp"
+#include "thread.hpp"
+#include "tt.hpp"
+#include "util.hpp"
+#include "var.hpp"
+
+// constants
+
+const Depth Corpus_Depth { Depth(6) }; // of the bench searches the corpus is taken from
+const int   Corpus_Size  { 4096 };     // positions, sampled evenly in visiting order
+const int   Runs         { 15 };       // per kernel, first one is warm-up
+
+const int Split_Moves       { 1 << 20 }; // handed out per split-point run, over all threads
+const int Split_Threads_Max { 8 };
+
+// types
+
+struct Pos_Move { // a legal move in a corpus position
+   int pos;
+   Move move;
+};
+
+struct Kernel {
+   const char * name;
+   uint64 (*run) (int64 & ops); // one pass over the corpus
+};
+
+struct Split_Model { // the shared state of Split_Point (search.cpp) under many threads, "searches" take no time
+
+   Lockable lock; // locked hand-out and merge, as before the atomics
+   int i;
+   int j;
+   int64 best;
+
+   std::atomic<int> a_i; // lock-free, as now
+   std::atomic<int> a_j;
+   std::atomic<uint64> a_best; // (score, move)
+
+   std::atomic<bool> go;
+};
+
+// variables
+
+static std::vector<Pos> G_Visited; // by the search, repeats included
+static std::vector<Pos> G_Corpus;
+static std::vector<Pos_Move> G_Moves;
+static std::vector<Pos_Move> G_Captures;
+
+static volatile uint64 G_Sink; // kernel results end up here, so the work cannot be optimised away
+
+// prototypes
+
+static void init_corpus ();
+static void visit       (const Pos & pos);
+
+static void run_kernel (const Kernel & kernel);
+
+static uint64 cycles ();
+
+static void   run_split     ();
+static double split_time    (int threads, bool locked);
+static void   split_locked  (Split_Model * sm);
+static void   split_atomics (Split_Model * sm);
+static int64  split_score   (int i);
+
+static uint64 k_succ         (int64 & ops);
+static uint64 k_gen_moves    (int64 & ops);
+static uint64 k_gen_captures (int64 & ops);
+static uint64 k_see          (int64 & ops);
+static uint64 k_is_check     (int64 & ops);
+static uint64 k_attack_info  (int64 & ops);
+static uint64 k_eval         (int64 & ops);
+static uint64 k_tt_store     (int64 & ops);
+static uint64 k_tt_probe     (int64 & ops);
+static uint64 k_rook_attacks (int64 & ops);
+
+// functions
+
+int main(int, char * []) {
+
+   math::init();
+   bit::init();
+   hash::init();
+   pawn::init();
+   init_eval(); // before any Pos
+   pos::init();
+   var::init();
+
+   var::update();
+
+   set_pawn_tables(1, int64(var::Pawn_Hash) << 20);
+   set_search_threads(1);
+   tt::G_TT.set_size(int64(var::Hash) << 20);
+
+   init_corpus();
+
+   std::cout << "corpus " << G_Corpus.size() << " positions, " << G_Moves.size() << " moves, " << G_Captures.size() << " captures" << std::endl;
+   std::cout << std::endl;
+
+   std::cout << std::left << std::setw(16) << "kernel" << std::right;
+   std::cout << std::setw(10) << "ns/op" << std::setw(12) << "cycles/op" << std::setw(10) << "stddev" << std::endl;
+
+   const Kernel kernel[] {
+      { "Pos::succ",    k_succ },
+      { "gen_moves",    k_gen_moves },
+      { "gen_captures", k_gen_captures },
+      { "see",          k_see },
+      { "is_check",     k_is_check },
+      { "Attack_Info",  k_attack_info },
+      { "eval",         k_eval },
+      { "TT::store",    k_tt_store },
+      { "TT::probe",    k_tt_probe },
+      { "rook_attacks", k_rook_attacks },
+   };
+
+   for (const Kernel & k : kernel) {
+      run_kernel(k);
+   }
+
+   run_split();
+
+   return EXIT_SUCCESS;
+}
+
+static void init_corpus() { // positions that a bench search visits, so weighted like the real workload (QS included)
+
+   Search_Input si;
+   si.depth = Corpus_Depth;
+
+   std::streambuf * out = std::cout.rdbuf(nullptr); // no search output
+   set_node_hook(visit);
+
+   for (int i = 0; i < bench_size(); i++) {
+      Search_Output so;
+      search(so, pos_from_fen(bench_fen(i)), si);
+   }
+
+   set_node_hook(nullptr);
+   std::cout.rdbuf(out);
+   std::cout.clear();
+
+   tt::G_TT.clear(); // kernels start from an empty table
+
+   int size = std::min(int(G_Visited.size()), Corpus_Size);
+
+   for (int i = 0; i < size; i++) {
+      G_Corpus.push_back(G_Visited[int64(i) * int64(G_Visited.size()) / size]);
+   }
+
+   std::cout << "corpus from " << G_Visited.size() << " search nodes at depth " << Corpus_Depth << std::endl;
+   G_Visited.clear();
+
+   for (int p = 0; p < int(G_Corpus.size()); p++) {
+
+      const Pos & pos = G_Corpus[p];
+
+      List list;
+      gen_legals(list, pos);
+
+      for (int i = 0; i < list.size(); i++) {
+         Move mv = list[i];
+         G_Moves.push_back(Pos_Move { p, mv });
+         if (move::is_capture(mv, pos)) G_Captures.push_back(Pos_Move { p, mv });
+      }
+   }
+}
+
+static void visit(const Pos & pos) {
+   G_Visited.push_back(pos);
+}
+
+static void run_kernel(const Kernel & kernel) {
+
+   std::vector<double> time; // ns/op
+   std::vector<double> cycle;
+
+   for (int r = 0; r < Runs; r++) {
+
+      int64 ops = 0;
+
+      Timer timer;
+      timer.start();
+      uint64 c0 = cycles();
+
+      G_Sink += kernel.run(ops);
+
+      uint64 c1 = cycles();
+      timer.stop();
+
+      if (r == 0) continue; // warm-up
+
+      time.push_back(timer.elapsed() * 1E9 / double(ops));
+      cycle.push_back(double(c1 - c0) / double(ops));
+   }
+
+   double mean = 0.0;
+   double mean_cycle = 0.0;
+
+   for (int i = 0; i < int(time.size()); i++) {
+      mean += time[i];
+      mean_cycle += cycle[i];
+   }
+
+   mean /= double(time.size());
+   mean_cycle /= double(time.size());
+
+   double var = 0.0;
+
+   for (int i = 0; i < int(time.size()); i++) {
+      var += (time[i] - mean) * (time[i] - mean);
+   }
+
+   double dev = std::sqrt(var / double(time.size()));
+
+   std::cout << std::left << std::setw(16) << kernel.name << std::right << std::fixed << std::setprecision(2);
+   std::cout << std::setw(10) << mean << std::setw(12) << mean_cycle << std::setw(9) << (dev / mean * 100.0) << "%" << std::endl;
+}
+
+static uint64 cycles() { // TSC: reference cycles, not core cycles under frequency scaling
+   return __rdtsc();
+}
+
+static void run_split() { // split-point contention: hand out a move, merge its result
+
+   std::cout << std::endl;
+   std::cout << std::left << std::setw(16) << "split point" << std::right;
+   std::cout << std::setw(10) << "threads" << std::setw(12) << "lock ns" << std::setw(12) << "atomic ns" << std::endl;
+
+   for (int threads = 1; threads <= Split_Threads_Max; threads *= 2) {
+
+      double lock = 1E9;
+      double atomic = 1E9;
+
+      for (int r = 0; r < Runs / 3; r++) { // best of
+         lock   = std::min(lock,   split_time(threads, true));
+         atomic = std::min(atomic, split_time(threads, false));
+      }
+
+      std::cout << std::left << std::setw(16) << "get_move+update" << std::right << std::fixed << std::setprecision(2);
+      std::cout << std::setw(10) << threads << std::setw(12) << lock * 1E9 / Split_Moves << std::setw(12) << atomic * 1E9 / Split_Moves << std::endl;
+   }
+
+   if (int(std::thread::hardware_concurrency()) < Split_Threads_Max) {
+      std::cout << "(" << std::thread::hardware_concurrency() << " hardware threads, more are time-sliced)" << std::endl;
+   }
+}
+
+static double split_time(int threads, bool locked) { // seconds for Split_Moves moves
+
+   Split_Model sm;
+
+   sm.i = 0;
+   sm.j = 0;
+   sm.best = -1;
+
+   sm.a_i = 0;
+   sm.a_j = 0;
+   sm.a_best = 0;
+
+   sm.go = false;
+
+   std::vector<std::thread> thread;
+
+   for (int t = 0; t < threads; t++) {
+      thread.push_back(std::thread(locked ? split_locked : split_atomics, &sm));
+   }
+
+   Timer timer;
+   timer.start();
+
+   sm.go = true;
+   for (auto & t : thread) t.join();
+
+   timer.stop();
+
+   G_Sink += uint64(sm.best) + sm.a_best + sm.j + sm.a_j;
+   return timer.elapsed();
+}
+
+static void split_locked(Split_Model * sm) {
+
+   while (!sm->go) {}
+
+   while (true) {
+
+      sm->lock.lock(); // get_move()
+      int i = sm->i++;
+      sm->lock.unlock();
+
+      if (i >= Split_Moves) break;
+
+      int64 sc = split_score(i);
+
+      sm->lock.lock(); // update()
+      sm->j++;
+      if (sc > sm->best) sm->best = sc;
+      sm->lock.unlock();
+   }
+}
+
+static void split_atomics(Split_Model * sm) { // fail-low merges only: results above alpha still lock, but they are rare
+
+   while (!sm->go) {}
+
+   while (true) {
+
+      int i = sm->a_i++; // get_move()
+      if (i >= Split_Moves) break;
+
+      uint64 sc = uint64(split_score(i));
+
+      sm->a_j++; // update()
+
+      uint64 best = sm->a_best;
+      while (sc > best && !sm->a_best.compare_exchange_weak(best, sc))
+         ;
+   }
+}
+
+static int64 split_score(int i) { // rising slowly with noise, so that some results improve the best
+   return (int64(i) << 8) ^ (int64(i) * 0x9E3779B1 & 0xFFFF);
+}
+
+static uint64 k_succ(int64 & ops) {
+
+   uint64 sink = 0;
+
+   for (const Pos_Move & pm : G_Moves) {
+      sink += uint64(G_Corpus[pm.pos].succ(pm.move).key());
+   }
+
+   ops = G_Moves.size();
+   return sink;
+}
+
+static uint64 k_gen_moves(int64 & ops) {
+
+   uint64 sink = 0;
+   List list;
+
+   for (const Pos & pos : G_Corpus) {
+      gen_moves(list, pos);
+      sink += list.size();
+   }
+
+   ops = G_Corpus.size();
+   return sink;
+}
+
+static uint64 k_gen_captures(int64 & ops) {
+
+   uint64 sink = 0;
+   List list;
+
+   for (const Pos & pos : G_Corpus) {
+      gen_captures(list, pos);
+      sink += list.size();
+   }
+
+   ops = G_Corpus.size();
+   return sink;
+}
+
+static uint64 k_see(int64 & ops) {
+
+   uint64 sink = 0;
+
+   for (const Pos_Move & pm : G_Captures) {
+      sink += see(pm.move, G_Corpus[pm.pos]);
+   }
+
+   ops = G_Captures.size();
+   return sink;
+}
+
+static uint64 k_is_check(int64 & ops) {
+
+   uint64 sink = 0;
+
+   for (const Pos_Move & pm : G_Moves) {
+      sink += move::is_check(pm.move, G_Corpus[pm.pos]);
+   }
+
+   ops = G_Moves.size();
+   return sink;
+}
+
+static uint64 k_attack_info(int64 & ops) {
+
+   uint64 sink = 0;
+   Attack_Info ai;
+
+   for (const Pos & pos : G_Corpus) {
+      ai.init(pos);
+      sink += ai.attacks(White);
+   }
+
+   ops = G_Corpus.size();
+   return sink;
+}
+
+static uint64 k_eval(int64 & ops) {
+
+   uint64 sink = 0;
+
+   for (const Pos & pos : G_Corpus) {
+      sink += eval(pos, pos.turn());
+   }
+
+   ops = G_Corpus.size();
+   return sink;
+}
+
+static uint64 k_tt_store(int64 & ops) {
+
+   for (int i = 0; i < int(G_Corpus.size()); i++) {
+
+      tt::Info info;
+      info.move = move::None;
+      info.score = Score(i % 100);
+      info.flag = Flag::Exact;
+      info.depth = Depth(i % 16);
+      info.eval = Score(0);
+
+      tt::G_TT.store(G_Corpus[i].key(), info);
+   }
+
+   ops = G_Corpus.size();
+   return 0;
+}
+
+static uint64 k_tt_probe(int64 & ops) {
+
+   uint64 sink = 0;
+
+   for (const Pos & pos : G_Corpus) {
+      tt::Info info;
+      if (tt::G_TT.probe(pos.key(), info)) sink += info.depth;
+   }
+
+   ops = G_Corpus.size();
+   return sink;
+}
+
+static uint64 k_rook_attacks(int64 & ops) {
+
+   uint64 sink = 0;
+
+   for (const Pos & pos : G_Corpus) {
+      for (int sq = 0; sq < Square_Size; sq++) {
+         sink += bit::rook_attacks(Square(sq), pos.pieces());
+      }
+   }
+
+   ops = int64(G_Corpus.size()) * Square_Size;
+   return sink;
+}
+
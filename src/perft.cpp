@@ -0,0 +1,245 @@
+
+// includes
+
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "common.hpp"
+#include "fen.hpp"
+#include "gen.hpp"
+#include "hash.hpp"
+#include "libmy.hpp"
+#include "list.hpp"
+#include "move.hpp"
+#include "perft.hpp"
+#include "pos.hpp"
+#include "util.hpp"
+#include "var.hpp"
+
+// constants
+
+const int Depth_Bits { 8 }; // data = count << 8 | depth
+
+// types
+
+class Perft_Hash { // lockless like the TT: lock = key ^ data, torn entries do not match
+
+private :
+
+   struct Entry {
+      std::atomic<uint64> lock;
+      std::atomic<uint64> data;
+   };
+
+   std::unique_ptr<Entry[]> p_table;
+   int64 p_size;
+
+public :
+
+   Perft_Hash ();
+
+   void set_size (int64 bytes);
+
+   bool on () const { return p_size != 0; }
+
+   bool  probe (Key key, Depth depth, int64 & count) const;
+   void  store (Key key, Depth depth, int64 count);
+};
+
+struct Perft_Case {
+   std::string fen;
+   std::vector<int64> count; // depth 1, 2, ...
+};
+
+// variables
+
+static Perft_Hash G_Perft_Hash;
+
+static const Perft_Case Perft_Suite[] { // standard positions, then Chess960
+   { Start_FEN, { 20, 400, 8902, 197281, 4865609 } },
+   { "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1", { 48, 2039, 97862, 4085603 } },
+   { "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1", { 14, 191, 2812, 43238, 674624 } },
+   { "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1", { 6, 264, 9467, 422333 } },
+   { "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8", { 44, 1486, 62379, 2103487 } },
+   { "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10", { 46, 2079, 89890, 3894594 } },
+   { "bqnb1rkr/pp3ppp/3ppn2/2p5/5P2/P2P4/NPP1P1PP/BQ1BNRKR w HFhf - 2 9", { 21, 528, 12189, 326672 } },
+   { "2nnrbkr/p1qppppp/8/1ppb4/6PP/3PP3/PPP2P2/BQNNRBKR w HEhe - 1 9", { 21, 807, 18002, 667366 } },
+};
+
+// prototypes
+
+static int64 perft_rec (const Pos & pos, Depth depth);
+
+static void perft_root (const Pos & pos, const List & list, Depth depth, std::atomic<int> * next, int64 * count);
+
+// functions
+
+void set_perft_hash(int64 bytes) {
+   G_Perft_Hash.set_size(bytes);
+}
+
+int64 perft(const Pos & pos, Depth depth, bool divide) {
+
+   assert(depth >= 0);
+
+   if (depth == 0) return 1;
+
+   List list;
+   gen_legals(list, pos);
+
+   // root moves are shared out to threads, first come first served
+
+   std::vector<int64> count(list.size(), 0);
+   std::atomic<int> next { 0 };
+
+   int threads = std::max(std::min(var::Threads, list.size()), 1);
+
+   std::vector<std::thread> thread;
+
+   for (int id = 1; id < threads; id++) {
+      thread.push_back(std::thread(perft_root, std::cref(pos), std::cref(list), depth, &next, count.data()));
+   }
+
+   perft_root(pos, list, depth, &next, count.data());
+
+   for (auto & t : thread) {
+      t.join();
+   }
+
+   int64 total = 0;
+
+   for (int i = 0; i < list.size(); i++) {
+      if (divide) std::cout << move::to_uci(list[i], pos) << ": " << count[i] << std::endl;
+      total += count[i];
+   }
+
+   return total;
+}
+
+static void perft_root(const Pos & pos, const List & list, Depth depth, std::atomic<int> * next, int64 * count) {
+
+   while (true) {
+
+      int i = (*next)++;
+      if (i >= list.size()) break;
+
+      count[i] = perft_rec(pos.succ(list[i]), depth - Depth(1));
+   }
+}
+
+static int64 perft_rec(const Pos & pos, Depth depth) {
+
+   if (depth == 0) return 1;
+
+   List list;
+   gen_legals(list, pos);
+
+   if (depth == 1) return list.size(); // bulk counting
+
+   int64 count;
+   if (G_Perft_Hash.on() && G_Perft_Hash.probe(pos.key(), depth, count)) return count;
+
+   count = 0;
+
+   for (int i = 0; i < list.size(); i++) {
+      count += perft_rec(pos.succ(list[i]), depth - Depth(1));
+   }
+
+   if (G_Perft_Hash.on()) G_Perft_Hash.store(pos.key(), depth, count);
+
+   return count;
+}
+
+bool perft_suite(Depth depth_max) {
+
+   int64 node = 0;
+   int fail = 0;
+
+   Timer timer;
+   timer.start();
+
+   int size = sizeof(Perft_Suite) / sizeof(Perft_Suite[0]);
+
+   for (int i = 0; i < size; i++) {
+
+      const Perft_Case & pc = Perft_Suite[i];
+
+      Pos pos = pos_from_fen(pc.fen);
+      Depth depth = Depth(std::min(int(depth_max), int(pc.count.size())));
+
+      int64 count = perft(pos, depth);
+      int64 expected = pc.count[depth - 1];
+
+      bool ok = count == expected;
+      if (!ok) fail += 1;
+
+      node += count;
+
+      std::cout << "perft " << (i + 1) << "/" << size << " depth " << depth << " " << count;
+      if (!ok) std::cout << " FAILED, expected " << expected;
+      std::cout << "   " << pc.fen << std::endl;
+   }
+
+   timer.stop();
+
+   double time = timer.elapsed();
+   double speed = (time < 0.01) ? 0.0 : double(node) / time;
+
+   std::cout << std::endl;
+   std::cout << ((fail == 0) ? "all ok" : std::to_string(fail) + " FAILED") << std::endl;
+   std::cout << "nodes " << node << std::endl;
+   std::cout << "time  " << ml::round(time * 1000.0) << " ms" << std::endl;
+   std::cout << "nps   " << ml::round(speed) << std::endl;
+
+   return fail == 0;
+}
+
+Perft_Hash::Perft_Hash() {
+   p_size = 0;
+}
+
+void Perft_Hash::set_size(int64 bytes) {
+
+   int64 size = bytes / int64(sizeof(Entry)); // any number of entries
+
+   p_table.reset((size == 0) ? nullptr : new Entry[size]);
+   p_size = size;
+
+   for (int64 i = 0; i < p_size; i++) {
+      p_table[i].lock.store(0, std::memory_order_relaxed);
+      p_table[i].data.store(0, std::memory_order_relaxed);
+   }
+}
+
+bool Perft_Hash::probe(Key key, Depth depth, int64 & count) const {
+
+   assert(on());
+
+   const Entry & entry = p_table[hash::index(key, p_size)];
+
+   uint64 data = entry.data.load(std::memory_order_relaxed);
+   if ((entry.lock.load(std::memory_order_relaxed) ^ data) != uint64(key)) return false;
+   if (int(data & ml::bit_mask(Depth_Bits)) != depth) return false;
+
+   count = int64(data >> Depth_Bits);
+   return true;
+}
+
+void Perft_Hash::store(Key key, Depth depth, int64 count) { // always replace
+
+   assert(on());
+
+   Entry & entry = p_table[hash::index(key, p_size)];
+
+   uint64 data = (uint64(count) << Depth_Bits) | uint64(depth);
+
+   entry.lock.store(uint64(key) ^ data, std::memory_order_relaxed);
+   entry.data.store(data, std::memory_order_relaxed);
+}
+
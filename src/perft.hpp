@@ -0,0 +1,20 @@
+
+#ifndef PERFT_HPP
+#define PERFT_HPP
+
+// includes
+
+#include "common.hpp"
+#include "libmy.hpp"
+
+class Pos;
+
+// functions
+
+void  set_perft_hash (int64 bytes); // 0 = none
+
+int64 perft       (const Pos & pos, Depth depth, bool divide = false); // var::Threads threads, root moves shared out
+bool  perft_suite (Depth depth_max); // known counts, Chess960 included
+
+#endif // !defined PERFT_HPP
+
@@ -9,6 +9,7 @@
 #include "attack.hpp"
 #include "bit.hpp"
 #include "common.hpp"
+#include "eval.hpp"
 #include "fen.hpp"
 #include "hash.hpp"
 #include "libmy.hpp"
@@ -88,6 +89,7 @@ void Pos::clear() {
    p_cap_sq = Square_None;
    p_key_piece = hash::key_turn(p_turn);
    p_key_pawn = Key(0);
+   p_psq = Score_Pair();
 }
 
 Pos Pos::succ(Move mv) const {
@@ -251,6 +253,8 @@ void Pos::add_piece(Piece pc, Side sd, Square sq) {
 
    p_key_piece ^= hash::key_piece(pc, sd, sq);
    if (pc == Pawn) p_key_pawn ^= hash::key_piece(pc, sd, sq);
+
+   p_psq += piece_square(pc, sd, sq);
 }
 
 void Pos::remove_piece(Piece pc, Side sd, Square sq) {
@@ -270,6 +274,8 @@ void Pos::remove_piece(Piece pc, Side sd, Square sq) {
 
    p_key_piece ^= hash::key_piece(pc, sd, sq);
    if (pc == Pawn) p_key_pawn ^= hash::key_piece(pc, sd, sq);
+
+   p_psq -= piece_square(pc, sd, sq);
 }
 
 bool Pos::is_draw() const {
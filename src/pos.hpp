@@ -7,10 +7,11 @@
 #include "bit.hpp"
 #include "common.hpp"
 #include "libmy.hpp"
+#include "score.hpp"
 
 // types
 
-class Pos { // 200 bytes
+class Pos { // 208 bytes
 
 private :
 
@@ -33,6 +34,7 @@ private :
    Key p_key_piece;
    Key p_key_pawn;
    Key p_key_full;
+   Score_Pair p_psq; // material + piece-square, White's point of view
 
 public :
 
@@ -73,6 +75,8 @@ public :
    Key    key       () const { return p_key_full; }
    Key    key_pawn  () const { return p_key_pawn; }
 
+   Score_Pair psq () const { return p_psq; }
+
    int  ply () const { return p_ply; }
 
    bool is_draw () const;
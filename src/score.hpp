@@ -7,6 +7,48 @@
 #include "common.hpp"
 #include "libmy.hpp"
 
+// types
+
+class Score_Pair { // middlegame and endgame, added as one integer
+
+private :
+
+   int64 p_vec;
+
+public :
+
+   Score_Pair () : Score_Pair(0) {}
+   explicit Score_Pair (int sc) : Score_Pair(sc, sc) {}
+   Score_Pair (int mg, int eg) { p_vec = (int64(mg) << 32) + int64(eg); } // HACK: "eg"'s sign leaks to "mg"
+
+   void operator += (Score_Pair sp) { p_vec += sp.p_vec; }
+   void operator -= (Score_Pair sp) { p_vec -= sp.p_vec; }
+
+   friend Score_Pair operator + (Score_Pair sp) { return make(+sp.p_vec); }
+   friend Score_Pair operator - (Score_Pair sp) { return make(-sp.p_vec); }
+
+   friend Score_Pair operator + (Score_Pair s0, Score_Pair s1) { return make(s0.p_vec + s1.p_vec); }
+   friend Score_Pair operator - (Score_Pair s0, Score_Pair s1) { return make(s0.p_vec - s1.p_vec); }
+
+   friend Score_Pair operator * (Score_Pair weight, int n) { return make(weight.p_vec * n); }
+
+   friend Score_Pair operator * (Score_Pair weight, double x) {
+      return Score_Pair(ml::round(double(weight.mg()) * x),
+                        ml::round(double(weight.eg()) * x));
+   }
+
+   int mg () const { return p_vec >> 32; }
+   int eg () const { return int(p_vec); } // extend sign
+
+private :
+
+   static Score_Pair make(int64 vec) {
+      Score_Pair sp;
+      sp.p_vec = vec;
+      return sp;
+   }
+};
+
 namespace score {
 
 // constants
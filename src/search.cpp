@@ -6,8 +6,10 @@
 #include <cstdio>
 #include <cstdlib>
 #include <iostream>
+#include <memory>
 #include <sstream>
 #include <string>
+#include <vector>
 
 #include "attack.hpp"
 #include "bit.hpp"
@@ -72,6 +74,7 @@ struct Node {
    bool futile;
 
    List list;
+   Move_Picker picker; // fills "list" in order
    List searched;
    int i;
    int j;
@@ -83,6 +86,65 @@ struct Node {
    const Pos & pos () const { return *p_pos; }
 };
 
+class Eval_Cache { // per thread, so no torn entries; entry = key bits 15-63 + (eval + Inf), index = key bits 0-14
+
+private :
+
+   static const int Size = 1 << 15; // 256 KiB
+   static const uint64 Low = Size - 1; // |eval| <= Inf, so eval + Inf fits too
+
+   uint64 p_entry[Size];
+
+public :
+
+   Eval_Cache () { clear(); } // eval only depends on the position, so entries stay valid across searches
+
+   void clear ();
+
+   bool probe (Key key, Score & sc) const;
+   void store (Key key, Score sc);
+};
+
+class Node_Stack { // per thread, so that nodes are referenced rather than copied
+
+private :
+
+   // frames are pushed by search() and search_root(), and by move_loop() for a split point (a copy of its node).
+   // A frame's ply is never below the one under it: helping only joins split points below our own.
+   // At most four frames share a ply: a node, its split-point copy, a singular search from that copy
+   // (skip_move set, so no further singular search) and that search's split-point copy.
+   // search() returns at Ply_Max, so plies 0 .. Ply_Max.
+
+   static const int Size = Ply_Size * 4;
+
+   Node p_node[Size];
+   int p_size;
+
+public :
+
+   void clear () { p_size = 0; }
+
+   Node & push () { assert(p_size < Size); return p_node[p_size++]; }
+   void   pop  () { assert(p_size > 0); p_size--; }
+
+   bool empty () const { return p_size == 0; }
+};
+
+class Frame { // scoped node, also released when unwinding after Abort
+
+private :
+
+   Node_Stack & p_stack;
+   Node & p_node;
+
+public :
+
+   explicit Frame (Node_Stack & stack) : p_stack(stack), p_node(stack.push()) {}
+   ~Frame () { p_stack.pop(); }
+
+   Node & node () const { return p_node; }
+};
+
 class Search_Global;
 class Search_Local;
 
@@ -92,53 +154,87 @@ private :
 
    Split_Point * p_parent;
    Search_Global * p_sg;
+   ID p_master;
 
-   Node p_node;
+   Node * p_node; // master's frame, alive until free(); move, score and PV change under lock
 
-   std::atomic<uint64> p_workers;
+   std::atomic<int> p_i; // next move to hand out
+   std::atomic<int> p_j; // moves searched, also the next slot in p_node->searched
+   std::atomic<uint64> p_best; // score and move, raised lock-free below alpha
+
+   std::atomic<int> p_workers; // count, not a set: no limit on thread IDs
    std::atomic<bool> p_stop;
+   std::atomic<bool> p_open; // moves left to hand out
 
 public :
 
-   void init_root  (int master);
-   void init       (int master, Split_Point * parent, Search_Global & sg, const Node & node);
-   void get_result (Node & node);
+   void init_root  (ID master);
+   void init       (ID master, Split_Point * parent, Search_Global & sg, Node & node);
+   void get_result ();
 
-   void enter (ID id);
-   void leave (ID id);
+   bool try_enter ();
+   bool leave     (); // true if now free
 
    Move get_move (Node & node);
    void update   (Move mv, Score sc, const Line & pv);
 
-   void stop_root ();
+   void abort () { p_stop = true; }
 
    bool is_child (Split_Point * sp);
 
+private :
+
+   Score best_score () const { return Score(int32(p_best.load() >> 32)); }
+   Move  best_move  () const { return Move(int32(p_best.load())); }
+
+   static uint64 pack (Score sc, Move mv) { return (uint64(uint32(sc)) << 32) | uint32(mv); }
+
+public :
+
    bool stop () const { return p_stop; }
    bool free () const { return p_workers == 0; }
 
    Split_Point * parent () const { return p_parent; }
-   const Node  & node   () const { return p_node; }
+   ID            master () const { return p_master; }
+   const Node  & node   () const { return *p_node; }
 };
 
-class Search_Local : public Lockable {
+class Search_Local : public Waitable {
 
 private :
 
    static const int Pool_Size = 10;
 
+   static const int Spin_Pause = 1 << 10; // then yield
+   static const int Spin_Yield = 1 << 6;  // then park
+
    std::thread p_thread;
    ID p_id;
 
-   std::atomic<Split_Point *> p_work;
+   std::atomic<bool> p_parked;
+   bool p_wake; // under lock
    ml::Array<Split_Point *, Ply_Size> p_stack;
-   Split_Point p_pool[Pool_Size];
+   Split_Point p_pool[Pool_Size]; // [0, p_pool_size) are published, oldest first
    std::atomic<int> p_pool_size;
+   Node_Stack p_frame;
 
    Search_Global * p_sg;
+   uint32 p_event; // last seen, see poll()
+
+   std::atomic<int64> p_node; // only we write it, others read it
+   int64 p_node_max; // exact when single-threaded, see Search_Global::poll() otherwise
+   std::atomic<int> p_ply_max; // likewise
+   tt::Stats p_tt_stats;
+   Pawn_Stats p_pawn_stats;
+   Eval_Stats p_eval_stats;
 
-   int64 p_node;
-   int p_ply_max;
+   Eval_Cache p_eval_cache; // static eval, mostly for QS nodes that the TT does not cover
+
+   Sort_Info p_sort; // killers, counter moves and history
+
+   Move  p_lazy_move; // helper's own root result
+   Score p_lazy_score;
+   Score p_lazy_last;
 
 public :
 
@@ -147,20 +243,30 @@ public :
 
    void start_iter ();
    void end_iter   (Search_Output & so);
+   void add_stats  (Search_Output & so) const; // once the threads are joined
 
    void search_all_try  (const Pos & pos, List & list, Depth depth);
    void search_root_try (const Pos & pos, const List & list, Depth depth);
 
-   void give_work (Split_Point * sp);
+   bool wake ();
+
+   int64 node () const { return p_node.load(std::memory_order_relaxed); }
 
-   bool idle (Split_Point * parent) const;
-   bool idle () const;
+   const Sort_Info & sort      () const { return p_sort; }
+   void              seed_sort (const Sort_Info & sort) { p_sort = sort; }
 
 private :
 
    static void launch (Search_Local * sl, Split_Point * root_sp);
 
    void idle_loop (Split_Point * wait_sp);
+   void lazy_loop ();
+
+   Split_Point * steal (Split_Point * wait_sp);
+   void          park  (Split_Point * wait_sp);
+
+   bool lazy_helper () const { return var::Lazy_SMP && p_id != ID_Main; }
+   bool lazy_skip   (Depth depth) const;
 
    void join      (Split_Point * sp);
    void move_loop (Split_Point * sp);
@@ -177,8 +283,6 @@ private :
 
    void split (Node & node);
 
-   static void gen_tacticals (List & list, const Pos & pos, Bit checks);
-
    static bool  prune  (Move mv, const Node & node);
    static Depth extend (Move mv, const Node & node);
    static Depth reduce (Move mv, const Node & node);
@@ -204,77 +308,133 @@ private :
    Split_Point * top_sp () const;
 };
 
-class Search_Global : public Lockable {
+class Search_Global : public Waitable {
 
 private :
 
+   struct PV_Info { // MultiPV line, as last reported
+      Score score;
+      Flag flag;
+      Line pv;
+   };
+
+   static const int Watch_Period = 5; // ms
+
    const Search_Input * p_si;
    Search_Output * p_so;
 
    const Pos * p_pos;
    List p_list;
+   List p_root_list; // untouched, for lazy helpers
 
-   Search_Local p_sl[16];
+   Search_Local * p_sl; // var::Threads, see set_search_threads()
 
    Split_Point p_root_sp;
 
    std::atomic<bool> p_ponder;
    std::atomic<bool> p_flag;
+   std::atomic<bool> p_eof; // seen by the watchdog, we exit once the threads are joined
 
    Move p_last_move;
    Score p_last_score;
 
+   // written by the search, read by the watchdog
+
    std::atomic<bool> p_change;
-   bool p_first;
+   std::atomic<bool> p_first;
    std::atomic<int> p_high;
-   bool p_drop;
-   double p_factor;
+   std::atomic<bool> p_drop;
+   std::atomic<double> p_factor;
+
+   std::atomic<Depth> p_depth;
+   std::atomic<int> p_depth_done; // last completed iteration, also for lazy helpers
+   std::atomic<Move> p_current_move;
+   std::atomic<int> p_current_number;
 
-   Depth p_depth;
-   Move p_current_move;
-   int p_current_number;
+   Sort_Info p_seed; // main thread's move-ordering state after its last iteration, under lock (Seed History)
+
+   int p_pv; // MultiPV line being searched, 0 = main line
+   std::vector<PV_Info> p_pv_info; // lines > 0, line 0 is *p_so
 
    double p_last_poll;
 
+   std::atomic<int> p_idle; // threads looking for work
+
+   std::thread p_watchdog;
+   bool p_watch_end; // under lock
+
+   std::atomic<uint32> p_event; // Event_Stop | split-point cut-offs * Event_Cut_Off
+
 public :
 
+   static const uint32 Event_Stop    = 1 << 0;
+   static const uint32 Event_Cut_Off = 1 << 1;
+
    void init (const Search_Input & si, Search_Output & so, const Pos & pos, const List & list);
    void end  ();
 
    void search        (Depth depth);
-   void collect_stats ();
+   void collect_stats      ();
+   void collect_hash_stats (); // after end()
+
+private :
+
+   void sort_lines (int lines);
+
+public :
 
    void new_best_move (Move mv, Score sc, Flag flag, Depth depth, const Line & pv, bool fail_low);
 
    void poll  ();
    void abort ();
 
+   void   cut_off ()       { p_event += Event_Cut_Off; }
+   uint32 event   () const { return p_event; }
+
    void disp_info (bool disp_move);
 
-   bool has_worker () const;
-   void broadcast  (Split_Point * sp);
+   bool has_worker () const { return p_idle > 0; }
+   void wake_idle  (int n);
+
+   void inc_idle () { p_idle += 1; }
+   void dec_idle () { p_idle -= 1; }
 
    const Pos & pos () const { return *p_pos; }
    List & list () { return p_list; } // HACK
+   const List & root_list () const { return p_root_list; }
 
    Split_Point * root_sp () { return &p_root_sp; }
 
+private :
+
+   void watch ();
+
+public :
+
    void search_move (Move mv, int searched_size);
 
+   void get_seed (Sort_Info & sort);
+
    void set_flag   () { p_flag = true; }
    void clear_flag () { p_flag = false; p_change = true; }
 
    void set_high   () { p_high += 1; clear_flag(); }
    void clear_high () { p_high -= 1; }
 
-   Score  score () const { return p_so->score; }
+   Score  score () const { return (p_pv == 0) ? p_so->score : p_pv_info[p_pv].score; }
    Depth  depth () const { return p_so->depth; }
    double time  () const { return p_so->time(); }
+   int64  node  () const;
+
+   int64 node_max () const { return p_si->node; }
+
+   Depth depth_done () const { return Depth(int(p_depth_done)); }
 
    bool ponder () const { return p_ponder; }
+   bool eof    () const { return p_eof; }
 
    Move  last_move  () const { return p_last_move; }
-   Score last_score () const { return p_last_score; }
+   Score last_score () const { return (p_pv == 0) ? p_last_score : p_pv_info[p_pv].score; } // lines > 0: read before searching
 
    bool   change () const { return p_change; }
    bool   first  () const { return p_first; }
@@ -288,10 +448,6 @@ public :
          Search_Local & sl (ID id)       { return p_sl[id]; }
 };
 
-struct SMP : public Lockable {
-   std::atomic<bool> busy;
-};
-
 class Abort : public std::exception {
 };
 
@@ -301,9 +457,13 @@ static int LMR_Red[32][64];
 
 static Time G_Time;
 
-static SMP G_SMP; // lock to create and broadcast split points
 static Lockable G_IO;
 
+static std::unique_ptr<Search_Local[]> G_Search_Local; // ~0.9 MB each, mostly the node stack and the eval cache
+static int G_Search_Local_Size = 0;
+
+static void (*G_Node_Hook) (const Pos & pos) = nullptr; // microbenchmark corpus
+
 // prototypes
 
 static double alloc_moves (const Pos & pos);
@@ -313,12 +473,29 @@ static double lerp (double mg, double eg, double phase);
 
 static double time_lag (double time);
 
-static void node_update (Node & node, Move mv, Score sc, const Line & pv, Search_Global & sg);
+static void node_copy_header (Node & node, const Node & from);
+static void node_update      (Node & node, Move mv, Score sc, const Line & pv, Search_Global & sg);
 
 static Flag flag (Score sc, Score alpha, Score beta);
 
 // functions
 
+void set_search_threads(int threads) {
+
+   assert(threads > 0);
+
+   if (threads != G_Search_Local_Size) {
+      G_Search_Local.reset(new Search_Local[threads]);
+      G_Search_Local_Size = threads;
+
+      std::cout << "info string search threads " << threads << ", " << sizeof(Search_Local) / 1024 << " KiB each" << std::endl;
+   }
+}
+
+void set_node_hook(void (*hook) (const Pos & pos)) {
+   G_Node_Hook = hook;
+}
+
 void search(Search_Output & so, const Pos & pos, const Search_Input & si) {
 
    for (int d = 1; d < 32; d++) {
@@ -337,6 +514,17 @@ void search(Search_Output & so, const Pos & pos, const Search_Input & si) {
 
    List list;
    gen_legals(list, pos);
+
+   if (si.search_moves.size() != 0) { // UCI "searchmoves", already checked for legality
+
+      List all = list;
+      list.clear();
+
+      for (int i = 0; i < all.size(); i++) {
+         if (list::has(si.search_moves, all[i])) list.add(all[i]);
+      }
+   }
+
    assert(list.size() != 0);
 
    if (si.move && !si.ponder && list.size() == 1) {
@@ -377,7 +565,10 @@ void search(Search_Output & so, const Pos & pos, const Search_Input & si) {
          Depth depth = Depth(d);
 
          sg.search(depth);
+
+         G_IO.lock(); // the watchdog's info line collects too
          sg.collect_stats();
+         G_IO.unlock();
 
          Move mv = so.move;
          double time = so.time();
@@ -392,6 +583,8 @@ void search(Search_Output & so, const Pos & pos, const Search_Input & si) {
 
          if (si.smart && sg.drop()) abort = false;
 
+         if (si.mate != 0 && score::is_win(so.score) && so.flag != Flag::Upper && score::ply(so.score) <= si.mate * 2 - 1) abort = true;
+
          if (abort) {
             sg.set_flag();
             if (!sg.ponder()) break;
@@ -406,8 +599,21 @@ void search(Search_Output & so, const Pos & pos, const Search_Input & si) {
    sg.disp_info(false);
    sg.end(); // sync with threads
 
+   if (sg.eof()) std::exit(EXIT_SUCCESS); // not from the watchdog: Search_Local destructors would find joinable threads
+
+   if (so.move == move::None) { // node limit hit during the first iteration
+      so.new_best_move(sg.list()[0]);
+   }
+
    so.end();
 
+   if (var::Hash_Stats) {
+      sg.collect_hash_stats();
+      std::cout << "info string hash " << so.tt_stats.to_string() << std::endl;
+      std::cout << "info string pawn hash " << so.pawn_stats.to_string() << std::endl;
+      std::cout << "info string eval cache " << so.eval_stats.to_string() << std::endl;
+   }
+
    // UCI analysis/ponder buffering
 
    while (!si.move || sg.ponder()) {
@@ -498,6 +704,9 @@ void Search_Input::init() {
 
    move = true;
    depth = Depth_Max;
+   node = int64(1) << 62;
+   mate = 0;
+   search_moves.clear();
 
    smart = false;
    moves = 0;
@@ -529,6 +738,9 @@ void Search_Output::init(const Search_Input & si, const Pos & pos) {
    p_timer.start();
    node = 0;
    ply_max = 0;
+   tt_stats.clear();
+   pawn_stats.clear();
+   eval_stats.clear();
 }
 
 void Search_Output::end() {
@@ -558,8 +770,12 @@ void Search_Output::new_best_move(Move mv, Score sc, Flag flag, Depth depth, con
 }
 
 void Search_Output::disp_best_move() {
+   disp_line((var::MultiPV > 1) ? 1 : 0, score, flag, depth, pv);
+}
+
+void Search_Output::disp_line(int multipv, Score sc, Flag flag, Depth depth, const Line & pv) const { // multipv = 0 => single PV
 
-   if (var::SMP) G_IO.lock();
+   G_IO.lock();
 
    double time = this->time();
    double speed = (time < 0.01) ? 0.0 : double(node) / time;
@@ -567,28 +783,30 @@ void Search_Output::disp_best_move() {
    std::string line = "info";
    if (depth != 0)   line += " depth "    + std::to_string(depth);
    if (ply_max != 0) line += " seldepth " + std::to_string(ply_max);
+   if (multipv != 0) line += " multipv "  + std::to_string(multipv);
 
-   if (score != score::None) {
+   if (sc != score::None) {
 
-      if (score::is_win(score)) {
-         line += " score mate " + std::to_string(+(score::ply(score) + 1) / 2);
-      } else if (score::is_loss(score)) {
-         line += " score mate " + std::to_string(-(score::ply(score) + 1) / 2);
+      if (score::is_win(sc)) {
+         line += " score mate " + std::to_string(+(score::ply(sc) + 1) / 2);
+      } else if (score::is_loss(sc)) {
+         line += " score mate " + std::to_string(-(score::ply(sc) + 1) / 2);
       } else {
-         line += " score cp " + std::to_string(score);
+         line += " score cp " + std::to_string(sc);
       }
 
       if (flag == Flag::Lower) line += " lowerbound";
       if (flag == Flag::Upper) line += " upperbound";
    }
 
-   if (node != 0)      line += " nodes " + std::to_string(node);
-   if (time >= 0.001)  line += " time "  + std::to_string(ml::round(time * 1000));
-   if (speed != 0.0)   line += " nps "   + std::to_string(ml::round(speed));
-   if (pv.size() != 0) line += " pv "    + pv.to_uci(p_pos);
+   if (node != 0)      line += " nodes "    + std::to_string(node);
+   if (time >= 0.001)  line += " time "     + std::to_string(ml::round(time * 1000));
+   if (speed != 0.0)   line += " nps "      + std::to_string(ml::round(speed));
+   if (node != 0)      line += " hashfull " + std::to_string(tt::G_TT.hashfull());
+   if (pv.size() != 0) line += " pv "       + pv.to_uci(p_pos);
    std::cout << line << std::endl;
 
-   if (var::SMP) G_IO.unlock();
+   G_IO.unlock();
 }
 
 double Search_Output::time() const {
@@ -648,9 +866,11 @@ void Search_Global::init(const Search_Input & si, Search_Output & so, const Pos
 
    p_pos = &pos;
    p_list = list;
+   p_root_list = list;
 
    p_ponder = si.ponder;
    p_flag = false;
+   p_eof = false;
 
    p_last_move = move::None;
    p_last_score = score::None;
@@ -662,23 +882,36 @@ void Search_Global::init(const Search_Input & si, Search_Output & so, const Pos
    p_factor = 1.0;
 
    p_depth = Depth(0);
+   p_depth_done = 0;
    p_current_move = move::None;
    p_current_number = 0;
 
+   p_seed.clear();
+
+   p_pv = 0;
+   p_pv_info.assign(var::MultiPV, PV_Info { score::None, Flag::None, Line() });
+
    p_last_poll = 0.0;
 
    // new search
 
-   G_SMP.busy = false;
+   p_idle = 0;
    p_root_sp.init_root(ID_Main);
 
+   p_event = 0;
+
+   assert(G_Search_Local_Size == var::Threads);
+   p_sl = G_Search_Local.get();
+
+   tt::G_TT.inc_date(); // before lazy helpers start storing
+
    for (int i = 0; i < var::Threads; i++) {
       ID id = ID(i);
       sl(id).init(id, *this); // also launches a thread if id /= 0
    }
 
-   tt::G_TT.inc_date();
-   sort_clear();
+   p_watch_end = false;
+   p_watchdog = std::thread(&Search_Global::watch, this);
 }
 
 void Search_Global::collect_stats() {
@@ -691,11 +924,33 @@ void Search_Global::collect_stats() {
    }
 }
 
+void Search_Global::collect_hash_stats() { // threads write their stats without synchronisation
+
+   p_so->tt_stats.clear();
+   p_so->pawn_stats.clear();
+   p_so->eval_stats.clear();
+
+   for (int id = 0; id < var::Threads; id++) {
+      sl(ID(id)).add_stats(*p_so);
+   }
+}
+
 void Search_Global::end() {
 
+   lock();
+   p_watch_end = true;
+   signal();
+   unlock();
+
+   p_watchdog.join(); // no more input handling from now on
+
    abort();
 
-   p_root_sp.leave(ID_Main);
+   p_root_sp.leave();
+
+   for (int id = 0; id < var::Threads; id++) { // idle helpers wait for the root to be free
+      sl(ID(id)).wake();
+   }
    assert(p_root_sp.free());
 
    for (int id = 0; id < var::Threads; id++) {
@@ -710,22 +965,99 @@ void Search_Global::search(Depth depth) {
    p_current_number = 0;
 
    for (int id = 0; id < var::Threads; id++) {
-      sl(ID(id)).start_iter();
+      if (!var::Lazy_SMP || id == ID_Main) sl(ID(id)).start_iter(); // lazy helpers have their own iterations
+   }
+
+   if (var::Seed_History && !var::Lazy_SMP) { // helpers are idle between iterations
+      for (int id = 1; id < var::Threads; id++) {
+         sl(ID(id)).seed_sort(sl(ID_Main).sort());
+      }
    }
 
    sl(ID_Main).search_root_try(pos(), p_list, depth);
 
+   int lines = std::min(var::MultiPV, p_list.size());
+
+   if (lines > 1) { // MultiPV: each line without the moves above it
+
+      for (p_pv = 1; p_pv < lines; p_pv++) {
+
+         List list;
+
+         for (int i = p_pv; i < p_list.size(); i++) {
+            list.add(p_list[i]);
+         }
+
+         sl(ID_Main).search_root_try(pos(), list, depth);
+      }
+
+      p_pv = 0;
+      sort_lines(lines);
+   }
+
    // time management
 
    Move  mv = p_so->move;
    Score sc = p_so->score;
 
    if (p_si->smart && depth > 1 && mv == p_last_move) {
-      p_factor = std::max(p_factor * 0.9, 0.6);
+      p_factor = std::max(factor() * 0.9, 0.6);
    }
 
    p_last_move = mv;
    p_last_score = sc;
+
+   if (var::Seed_History && var::Lazy_SMP) { // lazy helpers copy it whenever they start an iteration
+      lock();
+      p_seed = sl(ID_Main).sort();
+      unlock();
+   }
+
+   p_depth_done = depth;
+}
+
+void Search_Global::get_seed(Sort_Info & sort) {
+   lock();
+   sort = p_seed;
+   unlock();
+}
+
+void Search_Global::sort_lines(int lines) { // a later line can beat an earlier one; rank them and report them together
+
+   p_pv_info[0] = PV_Info { p_so->score, p_so->flag, p_so->pv };
+
+   for (int i = 1; i < lines; i++) { // insert sort (stable)
+
+      PV_Info info = p_pv_info[i];
+
+      int j;
+
+      for (j = i; j > 0 && info.score > p_pv_info[j - 1].score; j--) {
+         p_pv_info[j] = p_pv_info[j - 1];
+      }
+
+      p_pv_info[j] = info;
+   }
+
+   for (int i = 0; i < lines; i++) {
+      const PV_Info & info = p_pv_info[i];
+      p_list.mtf(list::find(p_list, info.pv[0]), i);
+   }
+
+   lock();
+
+   collect_stats();
+
+   const PV_Info & best = p_pv_info[0];
+   if (best.pv[0] != p_so->move) clear_flag(); // new best move
+   p_so->new_best_move(best.pv[0], best.score, best.flag, p_depth.load(), best.pv); // line 1
+
+   for (int i = 1; i < lines; i++) {
+      const PV_Info & info = p_pv_info[i];
+      p_so->disp_line(i + 1, info.score, info.flag, p_depth.load(), info.pv);
+   }
+
+   unlock();
 }
 
 void Search_Global::search_move(Move mv, int searched_size) {
@@ -738,7 +1070,19 @@ void Search_Global::search_move(Move mv, int searched_size) {
 
 void Search_Global::new_best_move(Move mv, Score sc, Flag flag, Depth depth, const Line & pv, bool fail_low) {
 
-   if (var::SMP) lock();
+   lock();
+
+   if (p_pv != 0) { // other MultiPV lines don't drive time management
+
+      collect_stats();
+      p_so->disp_line(p_pv + 1, sc, flag, depth, pv);
+
+      p_pv_info[p_pv] = PV_Info { sc, flag, pv };
+      p_list.mtf(list::find(p_list, mv), p_pv);
+
+      unlock();
+      return;
+   }
 
    Move bm = p_so->move;
 
@@ -753,8 +1097,8 @@ void Search_Global::new_best_move(Move mv, Score sc, Flag flag, Depth depth, con
       clear_flag();
 
       if (p_si->smart) {
-         p_factor = std::max(p_factor, 1.0);
-         p_factor = std::min(p_factor * 1.2, 2.0);
+         p_factor = std::max(factor(), 1.0);
+         p_factor = std::min(factor() * 1.2, 2.0);
       }
    }
 
@@ -762,27 +1106,41 @@ void Search_Global::new_best_move(Move mv, Score sc, Flag flag, Depth depth, con
    p_drop = fail_low || delta <= -20;
    if (delta <= -20) clear_flag();
 
-   if (var::SMP) unlock();
+   unlock();
 }
 
-void Search_Global::poll() {
+void Search_Global::watch() { // own thread: search threads only look at p_event
+
+   lock();
+
+   while (!p_watch_end) {
 
-   if (depth() <= 1) return;
+      unlock();
+      poll();
+      lock();
+
+      if (!p_watch_end) wait(double(Watch_Period) / 1000.0);
+   }
+
+   unlock();
+}
+
+void Search_Global::poll() {
 
    bool abort = false;
 
    // input event?
 
-   if (var::SMP) G_IO.lock();
+   G_IO.lock();
 
    if (has_input()) {
 
       std::string line;
       if (!peek_line(line)) { // EOF
-         std::exit(EXIT_SUCCESS);
-      }
-
-      if (!line.empty()) {
+         p_eof = true;
+         p_ponder = false;
+         abort = true;
+      } else if (!line.empty()) {
 
          std::stringstream ss(line);
 
@@ -804,13 +1162,15 @@ void Search_Global::poll() {
       }
    }
 
-   if (var::SMP) G_IO.unlock();
+   G_IO.unlock();
 
-   // time limit?
+   // time limit? (not before we have a move)
 
    double time = this->time();
 
    if (false) {
+   } else if (depth_done() < 1) {
+      // no-op
    } else if (time >= G_Time.time_2()) {
       abort = true;
    } else if (p_si->smart && (high() || drop())) {
@@ -823,6 +1183,8 @@ void Search_Global::poll() {
       abort = true;
    }
 
+   if (var::SMP && node() >= node_max()) abort = true; // threads only see their own count
+
    if (abort) {
       p_flag = true;
       if (!p_ponder) this->abort();
@@ -830,59 +1192,64 @@ void Search_Global::poll() {
 
    // send search info every second
 
-   if (var::SMP) lock();
+   lock();
 
    if (time >= p_last_poll + 1.0) {
       disp_info(true);
       p_last_poll += 1.0;
    }
 
-   if (var::SMP) unlock();
+   unlock();
+}
+
+int64 Search_Global::node() const {
+
+   int64 node = 0;
+
+   for (int id = 0; id < var::Threads; id++) {
+      node += sl(ID(id)).node();
+   }
+
+   return node;
 }
 
 void Search_Global::disp_info(bool disp_move) {
 
-   if (var::SMP) G_IO.lock();
+   G_IO.lock();
 
    collect_stats();
 
    double time = p_so->time();
    double speed = (time < 0.01) ? 0.0 : double(p_so->node) / time;
 
+   Depth depth = p_depth;
+   Move mv = p_current_move;
+   int number = p_current_number;
+
    std::string line = "info";
-   if (p_depth != 0)       line += " depth "    + std::to_string(p_depth);
+   if (depth != 0)         line += " depth "    + std::to_string(depth);
    if (p_so->ply_max != 0) line += " seldepth " + std::to_string(p_so->ply_max);
 
-   if (disp_move && p_current_move != move::None) line += " currmove "       + move::to_uci(p_current_move, pos());
-   if (disp_move && p_current_number != 0)        line += " currmovenumber " + std::to_string(p_current_number);
+   if (disp_move && mv != move::None) line += " currmove "       + move::to_uci(mv, pos());
+   if (disp_move && number != 0)      line += " currmovenumber " + std::to_string(number);
 
-   if (p_so->node != 0) line += " nodes " + std::to_string(p_so->node);
-   if (time >= 0.001)   line += " time "  + std::to_string(ml::round(time * 1000));
-   if (speed != 0.0)    line += " nps "   + std::to_string(ml::round(speed));
+   if (p_so->node != 0) line += " nodes "    + std::to_string(p_so->node);
+   if (time >= 0.001)   line += " time "     + std::to_string(ml::round(time * 1000));
+   if (speed != 0.0)    line += " nps "      + std::to_string(ml::round(speed));
+   if (p_so->node != 0) line += " hashfull " + std::to_string(tt().hashfull());
    std::cout << line << std::endl;
 
-   if (var::SMP) G_IO.unlock();
+   G_IO.unlock();
 }
 
 void Search_Global::abort() {
-   p_root_sp.stop_root();
-}
-
-bool Search_Global::has_worker() const {
-
-   if (G_SMP.busy) return false;
-
-   for (int id = 0; id < var::Threads; id++) {
-      if (sl(ID(id)).idle()) return true;
-   }
-
-   return false;
+   p_event |= Event_Stop;
 }
 
-void Search_Global::broadcast(Split_Point * sp) {
+void Search_Global::wake_idle(int n) { // new work was published; spinning threads find it themselves
 
-   for (int id = 0; id < var::Threads; id++) {
-      sl(ID(id)).give_work(sp);
+   for (int id = 0; id < var::Threads && n > 0; id++) {
+      if (sl(ID(id)).wake()) n--;
    }
 }
 
@@ -890,20 +1257,32 @@ void Search_Local::init(ID id, Search_Global & sg) {
 
    p_id = id;
 
-   p_work = sg.root_sp(); // to make it non-null
+   p_parked = false;
+   p_wake = false;
    p_stack.clear();
    p_pool_size = 0;
+   p_frame.clear();
 
    p_sg = &sg;
+   p_event = 0;
 
    p_node = 0;
+   p_node_max = sg.node_max();
    p_ply_max = 0;
+   p_tt_stats.clear();
+   p_pawn_stats.clear();
+   p_eval_stats.clear();
+   p_sort.clear();
 
    if (var::SMP && p_id != ID_Main) p_thread = std::thread(launch, this, sg.root_sp());
 }
 
 void Search_Local::launch(Search_Local * sl, Split_Point * root_sp) {
-   sl->idle_loop(root_sp);
+   if (var::Lazy_SMP) {
+      sl->lazy_loop();
+   } else {
+      sl->idle_loop(root_sp);
+   }
 }
 
 void Search_Local::end() {
@@ -918,57 +1297,167 @@ void Search_Local::start_iter() {
 void Search_Local::end_iter(Search_Output & so) {
 
    if (var::SMP || p_id == ID_Main) {
-      so.node += p_node;
-      so.ply_max = std::max(so.ply_max, p_ply_max);
+      so.node += node();
+      so.ply_max = std::max(so.ply_max, int(p_ply_max.load(std::memory_order_relaxed)));
+   }
+}
+
+void Search_Local::add_stats(Search_Output & so) const {
+
+   if (var::SMP || p_id == ID_Main) {
+      so.tt_stats.add(p_tt_stats);
+      so.pawn_stats.add(p_pawn_stats);
+      so.eval_stats.add(p_eval_stats);
    }
 }
 
 void Search_Local::idle_loop(Split_Point * wait_sp) {
 
    push_sp(wait_sp);
+   p_sg->inc_idle();
 
-   while (true) {
+   int spin = 0; // adaptive: pause, then yield, then park
 
-      assert(p_work == p_sg->root_sp());
-      p_work = nullptr;
+   while (!wait_sp->free()) {
 
-      while (!wait_sp->free() && p_work.load() == nullptr) // spin
-         ;
+      Split_Point * sp = steal(wait_sp);
+
+      if (sp == nullptr && spin >= Spin_Pause + Spin_Yield) {
 
-      Split_Point * work = p_work.exchange(p_sg->root_sp()); // to make it non-null
-      if (work == nullptr) break;
+         p_parked = true; // from now on, wake() sees us (seq_cst) ...
+         sp = steal(wait_sp); // ... so one last look is enough
 
-      join(work);
+         if (sp == nullptr) park(wait_sp);
+         p_parked = false;
+      }
+
+      if (sp != nullptr) {
+
+         p_sg->dec_idle();
+         join(sp);
+         p_sg->inc_idle();
+
+         spin = 0;
+
+      } else if (spin < Spin_Pause) {
+
+         ml::pause();
+         spin++;
+
+      } else if (spin < Spin_Pause + Spin_Yield) {
+
+         std::this_thread::yield();
+         spin++;
+      }
    }
 
+   p_sg->dec_idle();
    pop_sp(wait_sp);
 
    assert(wait_sp->free());
-   assert(p_work == p_sg->root_sp());
 }
 
-void Search_Local::give_work(Split_Point * sp) {
+Split_Point * Search_Local::steal(Split_Point * wait_sp) { // oldest (shallowest) published split point first
+
+   int threads = var::Threads;
+
+   for (int i = 0; i < Pool_Size; i++) {
+
+      for (int k = 1; k < threads; k++) {
+
+         Search_Local & sl = p_sg->sl(ID((p_id + k) % threads));
+         if (i >= sl.p_pool_size) continue;
 
-   if (idle(sp->parent())) {
+         Split_Point * sp = &sl.p_pool[i];
+         if (!sp->try_enter()) continue;
 
-      sp->enter(p_id);
+         if (sp->is_child(wait_sp)) return sp; // helpful master: only work below us
 
-      assert(p_work.load() == nullptr);
-      p_work = sp;
+         if (sp->leave()) p_sg->sl(sp->master()).wake();
+      }
    }
+
+   return nullptr;
 }
 
-bool Search_Local::idle(Split_Point * parent) const {
+void Search_Local::park(Split_Point * wait_sp) {
 
    lock();
-   bool idle = this->idle() && parent->is_child(top_sp());
+
+   while (!p_wake && !wait_sp->free()) {
+      wait();
+   }
+
+   p_wake = false;
+
    unlock();
+}
+
+void Search_Local::lazy_loop() { // helper: private iterative deepening, sharing only the TT
+
+   assert(lazy_helper());
+
+   const Pos & pos = p_sg->pos();
+   List list = p_sg->root_list();
+
+   p_lazy_last = score::None;
+
+   assert(p_stack.empty());
+   push_sp(p_sg->root_sp()); // for stop()
+
+   try {
+
+      for (int d = 1; d <= Depth_Max; d++) {
+
+         d = std::max(d, int(p_sg->depth_done())); // don't lag behind the main thread
+
+         Depth depth = Depth(d);
+         if (lazy_skip(depth)) continue;
+
+         start_iter();
+
+         if (var::Seed_History && p_sg->depth_done() != 0) p_sg->get_seed(p_sort); // published before p_depth_done
+
+         p_lazy_move = move::None;
+         p_lazy_score = score::None;
+
+         search_asp(pos, list, depth, Ply_Root);
+
+         if (p_lazy_move != move::None) list.mtf(list::find(list, p_lazy_move));
+         p_lazy_last = p_lazy_score;
+      }
 
-   return idle;
+   } catch (const Abort &) {
+
+      // no-op
+   }
+
+   pop_sp(p_sg->root_sp());
+   assert(p_stack.empty());
+   assert(p_frame.empty());
 }
 
-bool Search_Local::idle() const {
-   return p_work.load() == nullptr;
+bool Search_Local::lazy_skip(Depth depth) const { // spread helpers over depths
+
+   static const int Skip_Size [20] { 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 3, 3, 4, 4, 4, 4, 4, 4, 4, 4 };
+   static const int Skip_Phase[20] { 0, 1, 0, 1, 2, 3, 0, 1, 2, 3, 4, 5, 0, 1, 2, 3, 4, 5, 6, 7 };
+
+   assert(p_id != ID_Main);
+
+   int i = (p_id - 1) % 20;
+   return ((depth + Skip_Phase[i]) / Skip_Size[i]) % 2 != 0;
+}
+
+bool Search_Local::wake() {
+
+   if (!p_parked) return false;
+
+   lock();
+   p_wake = true;
+   signal();
+   unlock();
+
+   return true;
 }
 
 void Search_Local::search_all_try(const Pos & pos, List & list, Depth depth) {
@@ -983,13 +1472,12 @@ void Search_Local::search_all_try(const Pos & pos, List & list, Depth depth) {
    try {
       search_all(pos, list, depth, Ply_Root);
    } catch (const Abort &) {
-      pop_sp(p_sg->root_sp());
-      assert(p_stack.empty());
-      // throw;
+      // no-op, the iteration that follows will throw again
    }
 
    pop_sp(p_sg->root_sp());
    assert(p_stack.empty());
+   assert(p_frame.empty());
 }
 
 void Search_Local::search_root_try(const Pos & pos, const List & list, Depth depth) {
@@ -1011,26 +1499,33 @@ void Search_Local::search_root_try(const Pos & pos, const List & list, Depth dep
 
    pop_sp(p_sg->root_sp());
    assert(p_stack.empty());
+   assert(p_frame.empty());
 }
 
 void Search_Local::join(Split_Point * sp) {
 
-   // sp->enter(p_id);
    push_sp(sp);
 
-   try {
-      move_loop(sp);
-   } catch (const Abort &) {
-      // no-op
+   if (stop()) { // a cut-off above may predate our last event
+      sp->abort(); // doomed anyway, keep other thieves out
+   } else {
+      try {
+         move_loop(sp);
+      } catch (const Abort &) {
+         // no-op
+      }
    }
 
    pop_sp(sp);
-   sp->leave(p_id);
+   if (sp->leave()) p_sg->sl(sp->master()).wake(); // master may be parked on it
 }
 
 void Search_Local::move_loop(Split_Point * sp) {
 
-   Node node = sp->node(); // local copy
+   Frame frame(p_frame);
+   Node & node = frame.node();
+
+   node_copy_header(node, sp->node()); // "list" stays with the split point
 
    while (true) {
 
@@ -1082,8 +1577,8 @@ void Search_Local::search_asp(const Pos & pos, const List & list, Depth depth, P
    assert(depth > 0 && depth <= Depth_Max);
    assert(ply == Ply_Root);
 
-   Score last_score = p_sg->last_score();
-   assert(depth < 2 || last_score == p_sg->score());
+   Score last_score = lazy_helper() ? p_lazy_last : p_sg->last_score();
+   assert(depth < 2 || lazy_helper() || last_score == p_sg->score());
 
    // window loop
 
@@ -1099,7 +1594,7 @@ void Search_Local::search_asp(const Pos & pos, const List & list, Depth depth, P
          assert(-score::Eval_Inf <= alpha && alpha < beta && beta <= +score::Eval_Inf);
 
          search_root(pos, list, alpha, beta, depth, ply);
-         Score sc = p_sg->score();
+         Score sc = lazy_helper() ? p_lazy_score : p_sg->score();
 
          if (score::is_win_loss(sc)) {
             break;
@@ -1127,14 +1622,15 @@ void Search_Local::search_root(const Pos & pos, const List & list, Score alpha,
 
    // init
 
-   Node node;
+   Frame frame(p_frame);
+   Node & node = frame.node();
 
    node.p_pos = &pos;
    node.alpha = alpha;
    node.beta = beta;
    node.depth = depth;
    node.ply = ply;
-   node.root = ply == Ply_Root /* && skip_move == move::None */;
+   node.root = ply == Ply_Root && !lazy_helper(); // helpers don't report
    node.pv_node = beta != alpha + Score(1);
    node.checks = checks(pos);
    node.in_check = node.checks != 0;
@@ -1153,7 +1649,14 @@ void Search_Local::search_root(const Pos & pos, const List & list, Score alpha,
    // move loop
 
    node.list = list;
+   node.picker.init_list(node.list);
+
    move_loop(node);
+
+   if (lazy_helper()) {
+      p_lazy_move = node.move;
+      p_lazy_score = node.score;
+   }
 }
 
 Score Search_Local::search(const Pos & pos, Score alpha, Score beta, Depth depth, Ply ply, Move skip_move, Line & pv) {
@@ -1173,6 +1676,8 @@ Score Search_Local::search(const Pos & pos, Score alpha, Score beta, Depth depth
       return qs(pos, alpha, beta, Depth(0), ply, pv);
    }
 
+   if (G_Node_Hook != nullptr) G_Node_Hook(pos);
+
    // init
 
    pv.clear();
@@ -1181,7 +1686,8 @@ Score Search_Local::search(const Pos & pos, Score alpha, Score beta, Depth depth
 
    if (pos.is_draw()) return leaf(Score(0), ply);
 
-   Node node;
+   Frame frame(p_frame);
+   Node & node = frame.node();
 
    node.p_pos = &pos;
    node.alpha = alpha;
@@ -1214,7 +1720,7 @@ Score Search_Local::search(const Pos & pos, Score alpha, Score beta, Depth depth
    {
       tt::Info tt_info;
 
-      if (p_sg->tt().probe(key, tt_info)) {
+      if (p_sg->tt().probe(key, tt_info, &p_tt_stats)) {
 
          tt_move = tt_info.move;
          node.eval = tt_info.eval;
@@ -1226,6 +1732,7 @@ Score Search_Local::search(const Pos & pos, Score alpha, Score beta, Depth depth
             if ((flag_is_lower(tt_info.flag) && tt_info.score >= node.beta)
              || (flag_is_upper(tt_info.flag) && tt_info.score <= node.alpha)
              ) {
+               p_tt_stats.cut += 1;
                return tt_info.score;
             }
          }
@@ -1282,8 +1789,11 @@ Score Search_Local::search(const Pos & pos, Score alpha, Score beta, Depth depth
       if (node.depth <= 3) {
          sc = snmp(pos, node.beta, node.eval);
       } else {
+         Pos new_pos = pos.null();
+         p_sg->tt().prefetch(hash_key(new_pos));
+
          inc_node();
-         sc = -search(pos.null(), -node.beta, -node.beta + Score(1), node.depth - Depth(node.depth / 4 + 2) - Depth(1), node.ply + Ply(1), move::None, new_pv);
+         sc = -search(new_pos, -node.beta, -node.beta + Score(1), node.depth - Depth(node.depth / 4 + 2) - Depth(1), node.ply + Ply(1), move::None, new_pv);
       }
 
       if (sc >= node.beta) {
@@ -1311,16 +1821,9 @@ Score Search_Local::search(const Pos & pos, Score alpha, Score beta, Depth depth
    // move loop
 
    if (node.futile) {
-
-      gen_tacticals(node.list, pos, node.checks);
-      add_checks(node.list, pos);
-
-      if (tt_move != move::None) sort_tt_move(node.list, pos, tt_move);
-
+      node.picker.init_tacticals(node.list, pos, node.checks, tt_move, true);
    } else {
-
-      gen_moves(node.list, pos, node.checks);
-      sort_all(node.list, pos, tt_move, node.ply);
+      node.picker.init(node.list, pos, node.checks, tt_move, node.ply, p_sort);
    }
 
    move_loop(node);
@@ -1351,7 +1854,7 @@ cont : // epilogue
       tt_info.depth = node.depth;
       tt_info.eval = node.eval;
 
-      p_sg->tt().store(key, tt_info);
+      p_sg->tt().store(key, tt_info, &p_tt_stats);
    }
 
    // move-ordering statistics
@@ -1362,7 +1865,7 @@ cont : // epilogue
     && node.skip_move == move::None
     ) {
 
-      good_move(node.move, pos, node.ply);
+      p_sort.good_move(node.move, pos, node.ply);
 
       assert(list::has(node.searched, node.move));
 
@@ -1371,7 +1874,7 @@ cont : // epilogue
          Move mv = node.searched[i];
          if (mv == node.move) break;
 
-         if (!move::is_tactical(mv, pos)) bad_move(mv, pos, node.ply);
+         if (!move::is_tactical(mv, pos)) p_sort.bad_move(mv, pos, node.ply);
       }
    }
 
@@ -1385,7 +1888,7 @@ void Search_Local::move_loop(Node & node) {
    node.i = 0;
    node.j = 0;
 
-   while (node.score < node.beta && node.i < node.list.size()) {
+   while (node.score < node.beta) {
 
       int searched_size = node.j;
       assert(searched_size == node.searched.size());
@@ -1393,19 +1896,28 @@ void Search_Local::move_loop(Node & node) {
       // SMP
 
       if (var::SMP
+       && !var::Lazy_SMP
        && node.depth >= 6
        && searched_size != 0
-       && node.list.size() - searched_size >= 5
        && p_sg->has_worker()
        && p_pool_size < Pool_Size
        ) {
-         split(node);
-         return;
+
+         node.picker.flush(); // split points hand out moves from "list"
+
+         if (node.list.size() - searched_size >= 5) {
+            split(node);
+            return;
+         }
       }
 
       // search move
 
-      Move mv = node.list[node.i++];
+      Move mv = node.picker.next();
+      if (mv == move::None) break;
+
+      assert(mv == node.list[node.i]);
+      node.i++;
 
       if (node.root) p_sg->search_move(mv, searched_size);
 
@@ -1427,6 +1939,9 @@ Score Search_Local::search_move(Move mv, const Node & node, Line & pv) {
 
    int searched_size = node.j;
 
+   Pos new_pos = pos.succ(mv);
+   p_sg->tt().prefetch(hash_key(new_pos)); // in flight during the decisions below
+
    Depth ext = extend(mv, node);
    Depth red = reduce(mv, node);
    assert(ext == 0 || red == 0);
@@ -1463,8 +1978,6 @@ Score Search_Local::search_move(Move mv, const Node & node, Line & pv) {
 
    inc_node();
 
-   Pos new_pos = pos.succ(mv);
-
    if ((node.pv_node && searched_size != 0) || red != 0) {
 
       sc = -search(new_pos, -new_alpha - Score(1), -new_alpha, new_depth - red, node.ply + Ply(1), move::None, pv);
@@ -1492,6 +2005,8 @@ Score Search_Local::qs(const Pos & pos, Score alpha, Score beta, Depth depth, Pl
    assert(depth <= 0);
    assert(ply <= Ply_Max);
 
+   if (G_Node_Hook != nullptr) G_Node_Hook(pos);
+
    // init
 
    pv.clear();
@@ -1511,7 +2026,7 @@ Score Search_Local::qs(const Pos & pos, Score alpha, Score beta, Depth depth, Pl
 
       tt::Info tt_info;
 
-      if (p_sg->tt().probe(key, tt_info)) {
+      if (p_sg->tt().probe(key, tt_info, &p_tt_stats)) {
 
          tt_move = tt_info.move;
          eval = tt_info.eval;
@@ -1522,6 +2037,7 @@ Score Search_Local::qs(const Pos & pos, Score alpha, Score beta, Depth depth, Pl
           || (flag_is_upper(tt_info.flag) && tt_info.score <= alpha)
           ||  flag_is_exact(tt_info.flag)
           ) {
+            p_tt_stats.cut += 1;
             return tt_info.score;
          }
       }
@@ -1545,11 +2061,11 @@ Score Search_Local::qs(const Pos & pos, Score alpha, Score beta, Depth depth, Pl
    bool is_leaf = true;
 
    List list;
+   Move_Picker picker;
 
    if (in_check) {
 
-      gen_evasions(list, pos, checks);
-      sort_mvv_lva(list, pos);
+      picker.init_evasions(list, pos, checks, tt_move);
 
    } else {
 
@@ -1560,17 +2076,12 @@ Score Search_Local::qs(const Pos & pos, Score alpha, Score beta, Depth depth, Pl
       bs = eval;
       if (bs >= beta) goto cont;
 
-      gen_tacticals(list, pos, checks);
-      if (depth == 0) add_checks(list, pos);
+      picker.init_tacticals(list, pos, checks, tt_move, depth == 0);
    }
 
-   if (tt_move != move::None) sort_tt_move(list, pos, tt_move);
-
    // move loop
 
-   for (int i = 0; i < list.size(); i++) {
-
-      Move mv = list[i];
+   for (Move mv = picker.next(); mv != move::None; mv = picker.next()) {
 
       // depth limit
 
@@ -1632,7 +2143,7 @@ cont : // epilogue
       tt_info.depth = Depth(0);
       tt_info.eval = eval;
 
-      p_sg->tt().store(key, tt_info);
+      p_sg->tt().store(key, tt_info, &p_tt_stats);
    }
 
    return bs;
@@ -1690,47 +2201,25 @@ Score Search_Local::snmp(const Pos & pos, Score beta, Score eval) { // static NM
 
 void Search_Local::split(Node & node) {
 
-   p_sg->poll();
    poll();
 
-   G_SMP.lock(); // useful?
-
-   assert(!G_SMP.busy);
-   G_SMP.busy = true;
-
    assert(p_pool_size < Pool_Size);
-   Split_Point * sp = &p_pool[p_pool_size++];
+   Split_Point * sp = &p_pool[p_pool_size];
    sp->init(p_id, top_sp(), *p_sg, node);
 
-   p_sg->broadcast(sp);
-
-   assert(G_SMP.busy);
-   G_SMP.busy = false;
-
-   G_SMP.unlock();
+   p_pool_size += 1; // publish
+   p_sg->wake_idle(node.list.size() - node.i - 1); // enough for the remaining moves, the master takes one
 
    join(sp);
    idle_loop(sp);
 
-   sp->get_result(node);
+   sp->get_result();
 
    assert(p_pool_size > 0);
-   p_pool_size--;
+   p_pool_size -= 1;
    assert(sp == &p_pool[p_pool_size]);
 
-   poll();
-}
-
-void Search_Local::gen_tacticals(List & list, const Pos & pos, Bit checks) {
-
-   if (checks != 0) {
-      gen_eva_caps(list, pos, checks);
-      sort_mvv_lva(list, pos);
-   } else {
-      gen_captures  (list, pos);
-      sort_mvv_lva  (list, pos);
-      add_promotions(list, pos);
-   }
+   if (stop()) throw Abort(); // we may have consumed the event while helping
 }
 
 bool Search_Local::prune(Move mv, const Node & node) {
@@ -1828,9 +2317,16 @@ bool Search_Local::move_is_dangerous(Move mv, const Node & node) {
 }
 
 void Search_Local::inc_node() {
-   p_node += 1;
-   if ((p_node & ml::bit_mask(8)) == 0) p_sg->poll();
-   if ((p_node & ml::bit_mask(4)) == 0) poll();
+
+   int64 node = this->node() + 1;
+   p_node.store(node, std::memory_order_relaxed); // not an RMW: we are the only writer
+
+   if (node >= p_node_max) {
+      p_sg->abort();
+      throw Abort();
+   }
+
+   if ((node & ml::bit_mask(4)) == 0) poll();
 }
 
 Score Search_Local::leaf(Score sc, Ply ply) {
@@ -1840,11 +2336,26 @@ Score Search_Local::leaf(Score sc, Ply ply) {
 }
 
 void Search_Local::mark_leaf(Ply ply) {
-   p_ply_max = std::max(p_ply_max, int(ply));
+   if (ply > p_ply_max.load(std::memory_order_relaxed)) p_ply_max.store(ply, std::memory_order_relaxed);
 }
 
 Score Search_Local::eval(const Pos & pos) {
-   return ::eval(pos, pos.turn());
+
+   Key key = hash_key(pos);
+   Score sc;
+
+   p_eval_stats.probe += 1;
+
+   if (p_eval_cache.probe(key, sc)) {
+      p_eval_stats.hit += 1;
+      assert((p_eval_stats.hit & 63) != 0 || sc == ::eval(pos, pos.turn(), p_id)); // one hit in 64, a full eval is what the cache saves
+      return sc;
+   }
+
+   sc = ::eval(pos, pos.turn(), p_id, &p_pawn_stats);
+   p_eval_cache.store(key, sc);
+
+   return sc;
 }
 
 Key Search_Local::hash_key(const Pos & pos) {
@@ -1856,11 +2367,20 @@ bool Search_Local::null_bad(const Pos & pos, Side sd) {
        || pos.pawns(sd) == 0; // no pawns
 }
 
-void Search_Local::poll() {
+void Search_Local::poll() { // one load in the common case
+
+   uint32 event = p_sg->event();
+   if (event == p_event) return;
+
+   if ((event & Search_Global::Event_Stop) != 0) throw Abort(); // p_event not updated: keep throwing
+
+   p_event = event; // a cut-off somewhere, maybe above us
    if (stop()) throw Abort();
 }
 
-bool Search_Local::stop() const {
+bool Search_Local::stop() const { // full check: global flag and split-point chain
+
+   if ((p_sg->event() & Search_Global::Event_Stop) != 0) return true;
 
    for (Split_Point * sp = top_sp(); sp != nullptr; sp = sp->parent()) {
       if (sp->stop()) return true;
@@ -1869,22 +2389,14 @@ bool Search_Local::stop() const {
    return false;
 }
 
-void Search_Local::push_sp(Split_Point * sp) {
-
-   lock();
-
+void Search_Local::push_sp(Split_Point * sp) { // only this thread reads its stack
    if (!p_stack.empty()) assert(sp->is_child(top_sp()));
    p_stack.add(sp);
-
-   unlock();
 }
 
 void Search_Local::pop_sp(Split_Point * sp) { // sp for debug
-
-   lock();
    assert(top_sp() == sp);
    p_stack.remove();
-   unlock();
 }
 
 Split_Point * Search_Local::top_sp() const {
@@ -1892,70 +2404,154 @@ Split_Point * Search_Local::top_sp() const {
    return p_stack[p_stack.size() - 1];
 }
 
-void Split_Point::init_root(int master) {
+void Split_Point::init_root(ID master) {
 
    p_parent = nullptr;
+   p_master = master;
 
-   p_workers = ml::bit(master);
+   p_workers = 1; // master
    p_stop = false;
+   p_open = false; // never published
 }
 
-void Split_Point::init(int master, Split_Point * parent, Search_Global & sg, const Node & node) {
+void Split_Point::init(ID master, Split_Point * parent, Search_Global & sg, Node & node) {
 
    assert(parent != nullptr);
+   assert(node.searched.size() == node.j);
 
    p_parent = parent;
    p_sg = &sg;
+   p_master = master;
+
+   p_node = &node;
+   p_node->searched.set_size(node.list.size()); // room for all moves, filled in through p_j
 
-   p_node = node;
+   p_i = node.i;
+   p_j = node.j;
+   p_best = pack(node.score, node.move);
 
-   p_workers = ml::bit(master);
    p_stop = false;
-}
+   p_open = true;
 
-void Split_Point::get_result(Node & node) {
-   node = p_node;
+   p_workers = 1; // master; last, as thieves may enter as soon as it is non-zero
 }
 
-void Split_Point::enter(ID id) {
-   assert(!ml::bit_has(p_workers, id));
-   p_workers |= ml::bit(id);
-}
+void Split_Point::get_result() { // all helpers are gone
 
-void Split_Point::leave(ID id) {
-   assert(ml::bit_has(p_workers, id));
-   p_workers &= ~ml::bit(id);
-}
+   Node & node = *p_node;
 
-Move Split_Point::get_move(Node & node) {
+   node.i = std::min(int(p_i), node.list.size());
+   node.j = p_j;
+   node.searched.set_size(node.j);
 
-   Move mv = move::None;
+   if (best_move() != node.move) { // raised lock-free, below alpha
+      node.move = best_move();
+      node.score = best_score();
+      node.pv.set(node.move);
+   }
 
-   lock();
+   assert(node.score == best_score());
+}
 
-   if (p_node.score < p_node.beta && p_node.i < p_node.list.size()) {
+bool Split_Point::try_enter() { // lock-free; fails once the split point is finished
 
-      mv = p_node.list[p_node.i++];
+   if (p_stop || !p_open) return false;
 
-      node.score = p_node.score;
-      node.j = p_node.j;
+   int workers = p_workers;
+
+   while (workers != 0) {
+      if (p_workers.compare_exchange_weak(workers, workers + 1)) return true;
    }
 
-   unlock();
+   return false;
+}
 
-   return mv;
+bool Split_Point::leave() {
+   assert(p_workers > 0);
+   return --p_workers == 0;
+}
+
+Move Split_Point::get_move(Node & node) { // lock-free
+
+   if (best_score() >= p_node->beta) return move::None;
+
+   int size = p_node->list.size();
+   int i = p_i++;
+
+   if (i >= size - 1) p_open = false; // no point in helping anymore
+   if (i >= size) return move::None;
+
+   node.score = best_score();
+   node.j = p_j;
+
+   return p_node->list[i];
 }
 
 void Split_Point::update(Move mv, Score sc, const Line & pv) {
 
-   lock();
+   if (best_score() >= p_node->beta) return; // ignore superfluous moves after a fail high
+
+   int j = p_j++;
+   p_node->searched.set_move(j, mv);
+
+   if (sc <= best_score()) return; // rechecked below
+
+   if (sc > p_node->alpha) { // new PV or cut-off: move, score and PV together
+
+      lock();
 
-   if (p_node.score < p_node.beta) { // ignore superfluous moves after a fail high
-      node_update(p_node, mv, sc, pv, *p_sg);
-      if (p_node.score >= p_node.beta) p_stop = true;
+      if (sc > best_score()) { // lock-free updates never reach alpha
+
+         p_node->move = mv;
+         p_node->score = sc;
+         p_node->pv.concat(mv, pv);
+
+         p_best = pack(sc, mv);
+
+         if (p_node->root) {
+            p_sg->new_best_move(mv, sc, flag(sc, p_node->alpha, p_node->beta), p_node->depth, p_node->pv, false);
+         }
+
+         if (sc >= p_node->beta) {
+            p_stop = true;
+            p_sg->cut_off(); // after p_stop: threads below us will see both
+         }
+      }
+
+      unlock();
+
+   } else {
+
+      uint64 best = p_best;
+
+      while (sc > Score(int32(best >> 32)) && !p_best.compare_exchange_weak(best, pack(sc, mv)))
+         ;
    }
+}
 
-   unlock();
+static void node_copy_header(Node & node, const Node & from) { // no lists or PV: kilobytes that helpers don't need
+
+   node.p_pos = from.p_pos;
+
+   node.alpha = from.alpha;
+   node.beta = from.beta;
+   node.depth = from.depth;
+   node.ply = from.ply;
+   node.root = from.root;
+   node.pv_node = from.pv_node;
+   node.checks = from.checks;
+   node.in_check = from.in_check;
+   node.eval = from.eval;
+   node.skip_move = from.skip_move;
+   node.sing_move = from.sing_move;
+   node.sing_score = from.sing_score;
+   node.futile = from.futile;
+
+   node.i = from.i;
+   node.j = from.j;
+
+   node.move = move::None;
+   node.score = from.score;
 }
 
 static void node_update(Node & node, Move mv, Score sc, const Line & pv, Search_Global & sg) {
@@ -1976,10 +2572,6 @@ static void node_update(Node & node, Move mv, Score sc, const Line & pv, Search_
    }
 }
 
-void Split_Point::stop_root() {
-   p_stop = true;
-}
-
 bool Split_Point::is_child(Split_Point * sp) {
 
    for (Split_Point * s = this; s != nullptr; s = s->p_parent) {
@@ -1989,6 +2581,47 @@ bool Split_Point::is_child(Split_Point * sp) {
    return false;
 }
 
+void Eval_Cache::clear() {
+   for (int i = 0; i < Size; i++) {
+      p_entry[i] = 0;
+   }
+}
+
+bool Eval_Cache::probe(Key key, Score & sc) const { // index from the low bits, check the others
+
+   uint64 entry = p_entry[uint64(key) & Low];
+   if (((entry ^ uint64(key)) & ~Low) != 0) return false;
+
+   sc = Score(int(entry & Low) - score::Inf);
+   return true;
+}
+
+void Eval_Cache::store(Key key, Score sc) { // always replace
+   assert(score::is_eval(sc));
+   p_entry[uint64(key) & Low] = (uint64(key) & ~Low) | uint64(sc + score::Inf);
+}
+
+void Eval_Stats::clear() {
+   probe = 0;
+   hit = 0;
+}
+
+void Eval_Stats::add(const Eval_Stats & stats) {
+   probe += stats.probe;
+   hit += stats.hit;
+}
+
+std::string Eval_Stats::to_string() const {
+
+   double hit_rate = (probe == 0) ? 0.0 : double(hit) / double(probe);
+
+   std::string s;
+   s += "probes " + std::to_string(probe);
+   s += " hits " + std::to_string(hit) + " (" + std::to_string(ml::round(hit_rate * 100.0)) + "%)";
+
+   return s;
+}
+
 Line::Line() {
    clear();
 }
@@ -7,12 +7,14 @@
 #include <string>
 
 #include "common.hpp"
+#include "eval.hpp"
 #include "libmy.hpp"
+#include "list.hpp"
 #include "pos.hpp"
 #include "score.hpp"
+#include "tt.hpp"
 #include "util.hpp"
 
-class List;
 class Pos;
 
 // constants
@@ -49,12 +51,25 @@ public :
    std::string to_uci (const Pos & pos) const;
 };
 
+struct Eval_Stats { // per thread, eval cache
+   int64 probe;
+   int64 hit;
+
+   void clear ();
+   void add   (const Eval_Stats & stats);
+
+   std::string to_string () const;
+};
+
 class Search_Input {
 
 public :
 
    bool move;
    Depth depth;
+   int64 node;
+   int mate; // moves, 0 = none
+   List search_moves; // empty = all
 
    bool smart;
    int moves;
@@ -84,6 +99,9 @@ public :
 
    int64 node;
    int ply_max;
+   tt::Stats tt_stats;
+   Pawn_Stats pawn_stats;
+   Eval_Stats eval_stats;
 
 private :
 
@@ -103,12 +121,16 @@ public :
    void new_best_move (Move mv, Score sc, Flag flag, Depth depth, const Line & pv);
 
    void disp_best_move ();
+   void disp_line      (int multipv, Score sc, Flag flag, Depth depth, const Line & pv) const;
 
    double time () const;
 };
 
 // functions
 
+void set_search_threads (int threads); // per-thread search state, kept across searches
+void set_node_hook      (void (*hook) (const Pos & pos)); // sees every search and QS node, nullptr = none
+
 void search (Search_Output & so, const Pos & pos, const Search_Input & si);
 
 Move  quick_move  (const Pos & pos);
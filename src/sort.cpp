@@ -11,156 +11,282 @@
 #include "search.hpp"
 #include "sort.hpp"
 
-// types
+// prototypes
 
-class Killer {
+static int capture_score (Move mv, const Pos & pos);
 
-private :
+// functions
 
-   static const int Size = Ply_Size;
+void Sort_Info::clear() {
 
-   Move p_table[Size];
+   p_killer.clear();
+   p_counter.clear();
+   p_history.clear();
+}
 
-public :
+void Sort_Info::good_move(Move mv, const Pos & pos, Ply ply) {
 
-   void clear ();
-   void set   (Move mv, Ply ply);
+   assert(ply >= 0 && ply < Ply_Size);
 
-   Move move (Ply ply) const { return p_table[ply]; }
-};
+   Move_Index index = move::index(mv, pos);
+   Move_Index last_index = move::index_last_move(pos);
 
-class Counter {
+   p_killer.set(mv, ply);
+   if (last_index != Move_Index_None) p_counter.set(mv, last_index);
+   p_history.good(index);
+}
 
-private :
+void Sort_Info::bad_move(Move mv, const Pos & pos, Ply /* ply */) {
+   Move_Index index = move::index(mv, pos);
+   p_history.bad(index);
+}
 
-   static const int Size = Move_Index_Size;
+void Move_Picker::init(List & list, const Pos & pos, Bit checks, Move tt_move, Ply ply, const Sort_Info & sort) {
 
-   Move p_table[Size];
+   assert(ply >= 0 && ply < Ply_Size);
 
-public :
+   p_list = &list;
+   p_pos = &pos;
 
-   void clear ();
-   void set   (Move mv, Move_Index last_index);
+   p_step = Step::Good;
+   p_size = 0;
 
-   Move move (Move_Index last_index) const { return p_table[last_index]; }
-};
+   // ordering statistics are read now, children will update them
 
-class History {
+   Move_Index last_index = move::index_last_move(pos);
 
-private :
+   p_killer  = sort.killer(ply);
+   p_counter = (last_index != Move_Index_None) ? sort.counter(last_index) : move::None;
 
-   static const int Size = Move_Index_Size;
+   gen_moves(list, pos, checks);
 
-   static const int Prob_Bit   = 12;
-   static const int Prob_One   = 1 << Prob_Bit;
-   static const int Prob_Half  = 1 << (Prob_Bit - 1);
-   static const int Prob_Shift = 5; // smaller => more adaptive
+   for (int i = 0; i < list.size(); i++) {
+      Move mv = list[i];
+      list.set_score(i, move::is_tactical(mv, pos) ? Score_Tac + capture_score(mv, pos) : sort.history(move::index(mv, pos)));
+   }
 
-   int p_table[Size];
+   set_tt(tt_move);
+}
 
-public :
+void Move_Picker::init_tacticals(List & list, const Pos & pos, Bit checks, Move tt_move, bool checks_too) {
 
-   void clear ();
+   p_list = &list;
+   p_pos = &pos;
+   p_killer = move::None;
+   p_counter = move::None;
 
-   void good (Move_Index index);
-   void bad  (Move_Index index);
+   p_step = Step::Tacticals;
+   p_size = 0;
 
-   int score (Move_Index index) const { return p_table[index]; }
-};
+   if (checks != 0) {
+      gen_eva_caps(list, pos, checks);
+   } else {
+      gen_captures(list, pos);
+   }
 
-// variables
+   for (int i = 0; i < list.size(); i++) {
+      list.set_score(i, Score_Tac + capture_score(list[i], pos));
+   }
 
-static Killer G_Killer;
-static Counter G_Counter;
-static History G_History;
+   if (checks == 0) { // rest in generation order
+      add_promotions(list, pos);
+      if (checks_too) add_checks(list, pos);
+   }
 
-// prototypes
+   set_tt(tt_move);
+}
 
-static int capture_score (Move mv, const Pos & pos);
+void Move_Picker::init_evasions(List & list, const Pos & pos, Bit checks, Move tt_move) {
 
-// functions
+   p_list = &list;
+   p_pos = &pos;
+   p_killer = move::None;
+   p_counter = move::None;
 
-void sort_clear() {
+   p_step = Step::Tacticals;
+   p_size = 0;
 
-   G_Killer.clear();
-   G_Counter.clear();
-   G_History.clear();
+   gen_evasions(list, pos, checks);
+
+   for (int i = 0; i < list.size(); i++) {
+      list.set_score(i, Score_Tac + capture_score(list[i], pos));
+   }
+
+   set_tt(tt_move);
 }
 
-void good_move(Move mv, const Pos & pos, Ply ply) {
+void Move_Picker::init_list(List & list) {
 
-   assert(ply >= 0 && ply < Ply_Size);
+   p_list = &list;
+   p_pos = nullptr;
+   p_killer = move::None;
+   p_counter = move::None;
 
-   Move_Index index = move::index(mv, pos);
-   Move_Index last_index = move::index_last_move(pos);
+   p_step = Step::Rest;
+   p_size = 0;
+}
+
+Move Move_Picker::next() {
+
+   List & list = *p_list;
+
+   while (true) {
+
+      switch (p_step) {
+
+      case Step::Good : { // SEE is only paid for captures that are reached
+
+         int i = best(Score_Tac);
+
+         if (i < 0) {
+            p_step = Step::Killer;
+            break;
+         }
+
+         int sc = list.score(i);
+
+         if (sc < Score_TT && !move_is_safe(list[i], *p_pos)) {
+            list.set_score(i, sc - Score_Tac + Score_Bad);
+            break;
+         }
+
+         return take(i);
+      }
+
+      case Step::Killer : {
+
+         p_step = Step::Counter;
+
+         int i = find_quiet(p_killer);
+         if (i >= 0) return take(i);
+
+         break;
+      }
+
+      case Step::Counter : {
+
+         p_step = Step::Quiets;
+
+         int i = find_quiet(p_counter);
+         if (i >= 0) return take(i);
+
+         break;
+      }
 
-   G_Killer.set(mv, ply);
-   if (last_index != Move_Index_None) G_Counter.set(mv, last_index);
-   G_History.good(index);
+      case Step::Quiets : {
+
+         int i = best(0);
+         if (i >= 0) return take(i);
+
+         p_step = Step::Bad;
+         break;
+      }
+
+      case Step::Bad : {
+
+         int i = best(Score_Bad);
+         if (i >= 0) return take(i);
+
+         p_step = Step::Done;
+         break;
+      }
+
+      case Step::Tacticals : {
+
+         int i = best(Score_Tac);
+         if (i >= 0) return take(i);
+
+         p_step = Step::Rest;
+         break;
+      }
+
+      case Step::Rest : {
+
+         if (p_size < list.size()) return take(p_size);
+
+         p_step = Step::Done;
+         break;
+      }
+
+      case Step::Done : {
+
+         return move::None;
+      }
+      }
+   }
 }
 
-void bad_move(Move mv, const Pos & pos, Ply /* ply */) {
-   Move_Index index = move::index(mv, pos);
-   G_History.bad(index);
+void Move_Picker::flush() {
+
+   int size = p_size;
+   while (next() != move::None) {}
+
+   p_size = size;
+   p_step = Step::Rest;
 }
 
-void sort_mvv_lva(List & list, const Pos & pos) {
+void Move_Picker::set_tt(Move tt_move) {
 
-   if (list.size() <= 1) return;
+   if (tt_move == move::None) return;
 
-   for (int i = 0; i < list.size(); i++) {
+   int i = list::find(*p_list, tt_move);
+   if (i >= 0) p_list->set_score(i, Score_TT);
+}
 
-      Move mv = list[i];
+int Move_Picker::best(int min) const { // same order as List::sort(): score, then move
 
-      int sc = capture_score(mv, pos);
-      list.set_score(i, sc);
+   const List & list = *p_list;
+
+   int bi = -1;
+   int bs = 0;
+
+   for (int i = p_size; i < list.size(); i++) {
+
+      int sc = list.score(i);
+      if (sc < min) continue;
+
+      if (bi < 0 || sc > bs || (sc == bs && int(list[i]) > int(list[bi]))) {
+         bi = i;
+         bs = sc;
+      }
    }
 
-   list.sort();
+   return bi;
 }
 
-void sort_all(List & list, const Pos & pos, Move tt_move, Ply ply) {
+int Move_Picker::find_quiet(Move mv) const {
 
-   assert(ply >= 0 && ply < Ply_Size);
+   if (mv == move::None) return -1;
 
-   if (list.size() <= 1) return;
+   const List & list = *p_list;
 
-   Move_Index last_index = move::index_last_move(pos);
+   for (int i = p_size; i < list.size(); i++) {
+      if (list[i] == mv) return (list.score(i) >= 0) ? i : -1;
+   }
+
+   return -1;
+}
+
+Move Move_Picker::take(int i) {
+   p_list->mtf(i, p_size);
+   return (*p_list)[p_size++];
+}
+
+void sort_mvv_lva(List & list, const Pos & pos) {
+
+   if (list.size() <= 1) return;
 
    for (int i = 0; i < list.size(); i++) {
 
-      Move mv = list.move(i);
-      Move_Index index = move::index(mv, pos);
-
-      int sc;
-
-      if (mv == tt_move) {
-         sc = (2 << 12) - 1;
-      } else if (move::is_tactical(mv, pos)) {
-         sc = (1 << 12);
-         sc += capture_score(mv, pos);
-         if (!move_is_safe(mv, pos)) sc -= (2 << 12);
-      } else if (mv == G_Killer.move(ply)) {
-         sc = (1 << 12) - 1;
-      } else if (last_index != Move_Index_None && mv == G_Counter.move(last_index)) {
-         sc = (1 << 12) - 2;
-      } else {
-         sc = (0 << 12);
-         sc += G_History.score(index);
-      }
+      Move mv = list[i];
 
-      assert(std::abs(sc) < (1 << 15));
+      int sc = capture_score(mv, pos);
       list.set_score(i, sc);
    }
 
    list.sort();
 }
 
-void sort_tt_move(List & list, const Pos & /* pos */, Move tt_move) {
-   int i = list::find(list, tt_move);
-   if (i >= 0) list.mtf(i);
-}
-
 static int capture_score(Move mv, const Pos & pos) { // MVV/LVA
 
    assert(!move::is_castling(mv));
@@ -6,20 +6,129 @@
 
 #include "common.hpp"
 #include "libmy.hpp"
+#include "search.hpp"
 
 class List;
 class Pos;
 
-// functions
+// types
+
+class Killer {
+
+private :
+
+   static const int Size = Ply_Size;
+
+   Move p_table[Size];
+
+public :
+
+   void clear ();
+   void set   (Move mv, Ply ply);
+
+   Move move (Ply ply) const { return p_table[ply]; }
+};
+
+class Counter {
+
+private :
+
+   static const int Size = Move_Index_Size;
+
+   Move p_table[Size];
+
+public :
+
+   void clear ();
+   void set   (Move mv, Move_Index last_index);
+
+   Move move (Move_Index last_index) const { return p_table[last_index]; }
+};
+
+class History {
+
+private :
+
+   static const int Size = Move_Index_Size;
+
+   static const int Prob_Bit   = 12;
+   static const int Prob_One   = 1 << Prob_Bit;
+   static const int Prob_Half  = 1 << (Prob_Bit - 1);
+   static const int Prob_Shift = 5; // smaller => more adaptive
+
+   int p_table[Size];
+
+public :
+
+   void clear ();
 
-void sort_clear ();
+   void good (Move_Index index);
+   void bad  (Move_Index index);
 
-void good_move (Move mv, const Pos & pos, Ply ply);
-void bad_move  (Move mv, const Pos & pos, Ply ply);
+   int score (Move_Index index) const { return p_table[index]; }
+};
+
+class Sort_Info { // move-ordering state, owned by one search thread (a few KB, so threads never share a cache line)
+
+private :
+
+   Killer p_killer;
+   Counter p_counter;
+   History p_history;
+
+public :
+
+   void clear ();
+
+   void good_move (Move mv, const Pos & pos, Ply ply);
+   void bad_move  (Move mv, const Pos & pos, Ply ply);
+
+   Move killer  (Ply ply)               const { return p_killer.move(ply); }
+   Move counter (Move_Index last_index) const { return p_counter.move(last_index); }
+   int  history (Move_Index index)      const { return p_history.score(index); }
+};
+
+class Move_Picker { // staged: moves are selected, and captures SEE-tested, only as far as the node gets
+
+private :
+
+   enum class Step : int { Good, Killer, Counter, Quiets, Bad, Tacticals, Rest, Done };
+
+   static const int Score_TT  = +(1 << 14);
+   static const int Score_Tac = +(1 << 13); // + MVV/LVA
+   static const int Score_Bad = -(1 << 13); // + MVV/LVA
+
+   List * p_list; // [0, p_size) handed out, in order
+   const Pos * p_pos;
+
+   Move p_killer; // read at init, like the history scores
+   Move p_counter;
+
+   Step p_step;
+   int p_size;
+
+public :
+
+   void init           (List & list, const Pos & pos, Bit checks, Move tt_move, Ply ply, const Sort_Info & sort);
+   void init_tacticals (List & list, const Pos & pos, Bit checks, Move tt_move, bool checks_too);
+   void init_evasions  (List & list, const Pos & pos, Bit checks, Move tt_move);
+   void init_list      (List & list); // already ordered
+
+   Move next  ();
+   void flush (); // order the whole list, for split points
+
+private :
+
+   void set_tt (Move tt_move);
+
+   int  best       (int min) const;
+   int  find_quiet (Move mv) const;
+   Move take       (int i);
+};
+
+// functions
 
 void sort_mvv_lva (List & list, const Pos & pos);
-void sort_all     (List & list, const Pos & pos, Move tt_move, Ply ply);
-void sort_tt_move (List & list, const Pos & pos, Move tt_move);
 
 #endif // !defined SORT_HPP
 
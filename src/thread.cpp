@@ -1,6 +1,7 @@
 
 // includes
 
+#include <chrono>
 #include <fstream>
 #include <iostream>
 #include <string>
@@ -158,6 +159,10 @@ void Waitable::wait() {
    p_cond.wait(p_mutex); // HACK: direct access
 }
 
+void Waitable::wait(double time) {
+   p_cond.wait_for(p_mutex, std::chrono::duration<double>(time)); // HACK: direct access
+}
+
 void Waitable::signal() {
    p_cond.notify_one();
 }
@@ -36,6 +36,7 @@ private :
 public :
 
    void wait   ();
+   void wait   (double time); // seconds, returns on time-out too
    void signal ();
 };
 
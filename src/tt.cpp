@@ -1,69 +1,183 @@
 
 // includes
 
+#include <algorithm>
+#include <atomic>
 #include <cstdio>
 #include <cstring>
+#include <fstream>
+#include <string>
+#include <thread>
 #include <vector>
 
 #include "common.hpp"
 #include "hash.hpp"
 #include "libmy.hpp"
 #include "move.hpp"
+#include "pos.hpp"
 #include "score.hpp"
 #include "tt.hpp"
+#include "var.hpp"
 
 namespace tt {
 
 // constants
 
-const int Cluster_Size { 4 };
+const int64 Clear_Chunk { int64(1) << 24 }; // bytes per clearing thread, at least
+
+const int Hashfull_Sample { 1000 }; // entries, about
 
 const int Depth_Min { -1 };
 
+// data layout: move + 1 (16), score (16), eval (16), depth - Depth_Min (8), date (4), flag (2)
+// all-zero entry = empty
+
+const int Move_Shift  {  0 };
+const int Score_Shift { 16 };
+const int Eval_Shift  { 32 };
+const int Depth_Shift { 48 };
+const int Date_Shift  { 56 };
+const int Flag_Shift  { 60 };
+
+// hash file: header padded to a page, then the raw table (copy-on-write mapped on load)
+
+const int64  File_Header_Size { 4096 };
+const uint32 File_Version     { 2 };
+
+const char File_Magic[8] { 'S', 'E', 'N', 'P', 'A', 'I', 'T', 'T' };
+
+// types
+
+struct File_Header {
+   char magic[8];
+   uint32 version;
+   uint32 cluster_size; // bytes
+   int32 entries; // per cluster
+   int32 pad; // #
+   int64 size; // clusters
+   uint64 key; // start-position key, detects different Zobrist keys
+   int32 date;
+};
+
 // variables
 
 TT G_TT;
 
 // functions
 
-TT::TT() {
+bool Cluster_4::match(int i, Key key, uint64 data) const {
+   return (p_entry[i].lock.load(std::memory_order_relaxed) ^ data) == uint64(key); // only complete entries pass
 }
 
-void TT::set_size(int size) {
+void Cluster_4::write(int i, Key key, uint64 data) {
+   p_entry[i].lock.store(uint64(key) ^ data, std::memory_order_relaxed);
+   p_entry[i].data.store(data, std::memory_order_relaxed);
+}
 
-   assert(ml::is_power_2(size));
+bool Cluster_6::match(int i, Key key, uint64 data) const {
+   return data != 0 && p_lock[i].load(std::memory_order_relaxed) == lock(key, data);
+}
 
-   p_size = size;
-   p_mask = (size - 1) & -Cluster_Size;
+void Cluster_6::write(int i, Key key, uint64 data) {
+   p_lock[i].store(lock(key, data), std::memory_order_relaxed);
+   p_data[i].store(data, std::memory_order_relaxed);
+}
 
-   p_table.resize(p_size);
+uint16 Cluster_6::lock(Key key, uint64 data) { // torn writes are caught with probability 1 - 2^-16
+   return uint16(hash::lock(key)) ^ uint16(data) ^ uint16(data >> 16) ^ uint16(data >> 32) ^ uint16(data >> 48);
+}
+
+template <class Cluster>
+Table<Cluster>::Table() {
+   p_table = nullptr;
+   p_pages = ml::Pages::Normal;
+   p_size = 0;
+   p_clean = true;
+}
+
+template <class Cluster>
+Table<Cluster>::~Table() {
+   free_table();
+}
+
+template <class Cluster>
+void Table<Cluster>::set_size(int64 bytes) {
 
-   clear();
+   assert(sizeof(Cluster) == 64);
+
+   int64 size = std::max(bytes / int64(sizeof(Cluster)), int64(1)); // any number of clusters
+
+   free_table();
+   p_table = static_cast<Cluster *>(ml::alloc_large(size * sizeof(Cluster), p_pages));
+
+   p_size = size;
+
+   if (p_pages == ml::Pages::Normal) {
+      p_clean = false;
+      clear();
+   } else { // fresh mmap: already zero, pages are cleared on first touch
+      set_date(0);
+      p_clean = true;
+   }
 }
 
-void TT::clear() {
+template <class Cluster>
+void Table<Cluster>::clear() {
 
-   assert(sizeof(Entry) == 16);
+   if (p_clean) return;
 
-   Entry entry { 0, 0, 0, 0, 0, 0, 0, 0, 0 };
+   int64 size = bytes();
 
-   entry.move = int(move::None);
-   entry.score = score::None;
-   entry.depth = Depth_Min;
-   entry.eval = score::None;
+   int threads = int(std::min(int64(var::Threads), (size + Clear_Chunk - 1) / Clear_Chunk));
+   threads = std::max(threads, 1);
 
-   for (int i = 0; i < p_size; i++) {
-      p_table[i] = entry;
+   std::vector<std::thread> thread;
+
+   for (int id = 1; id < threads; id++) {
+      thread.push_back(std::thread(&Table::clear_range, this, id, threads));
+   }
+
+   clear_range(0, threads);
+
+   for (auto & t : thread) {
+      t.join();
    }
 
    set_date(0);
+   p_clean = true;
+}
+
+template <class Cluster>
+void Table<Cluster>::free_table() {
+
+   if (p_pages == ml::Pages::File) {
+      ml::unmap_file(reinterpret_cast<char *>(p_table) - File_Header_Size, File_Header_Size + bytes());
+   } else {
+      ml::free_large(p_table, bytes(), p_pages);
+   }
+
+   p_table = nullptr;
+}
+
+template <class Cluster>
+void Table<Cluster>::clear_range(int id, int threads) { // all-zero entries are empty
+
+   assert(id >= 0 && id < threads);
+
+   int64 begin = p_size * id / threads;
+   int64 end   = p_size * (id + 1) / threads;
+
+   std::memset(static_cast<void *>(&p_table[begin]), 0, (end - begin) * sizeof(Cluster));
 }
 
-void TT::inc_date() {
+template <class Cluster>
+void Table<Cluster>::inc_date() { // called at the start of each search
    set_date((p_date + 1) % Date_Size);
+   p_clean = false;
 }
 
-void TT::set_date(int date) {
+template <class Cluster>
+void Table<Cluster>::set_date(int date) {
 
    assert(date >= 0 && date < Date_Size);
 
@@ -74,7 +188,8 @@ void TT::set_date(int date) {
    }
 }
 
-int TT::age(int date) const {
+template <class Cluster>
+int Table<Cluster>::age(int date) const {
 
    assert(date >= 0 && date < Date_Size);
 
@@ -85,7 +200,8 @@ int TT::age(int date) const {
    return age;
 }
 
-void TT::store(Key key, const Info & info) {
+template <class Cluster>
+void Table<Cluster>::store(Key key, const Info & info, Stats * stats) {
 
    assert(info.move != move::Null);
    assert(int(info.move) > -(1 << 15) && int(info.move) < +(1 << 15));
@@ -95,32 +211,34 @@ void TT::store(Key key, const Info & info) {
 
    // probe
 
-   int    index = hash::index(key, p_mask);
-   uint32 lock  = hash::lock(key);
+   if (stats != nullptr) stats->store += 1;
+
+   Cluster & cluster = p_table[hash::index(key, p_size)];
 
-   Entry * be = nullptr;
+   int bi = -1;
+   uint64 bd = 0;
    int bs = -64;
 
-   for (int i = 0; i < Cluster_Size; i++) {
+   for (int i = 0; i < Cluster::Size; i++) {
 
-      assert(index + i < p_size);
-      Entry & entry = p_table[index + i];
+      uint64 data = cluster.data(i);
 
-      if (entry.lock == lock) { // hash hit
+      Info old;
+      unpack(data, old);
 
-         if (entry.depth <= info.depth) {
+      if (cluster.match(i, key, data)) { // hash hit
 
-            assert(entry.lock == lock);
-            entry.date = p_date;
-            if (info.move != move::None) entry.move = int(info.move);
-            entry.score = info.score;
-            entry.flag = int(info.flag);
-            entry.depth = info.depth;
-            if (info.eval != score::None) entry.eval = info.eval;
+         if (old.depth <= info.depth) {
+
+            Info new_info = info;
+            if (info.move == move::None) new_info.move = old.move;
+            if (info.eval == score::None) new_info.eval = old.eval;
+
+            cluster.write(i, key, pack(new_info));
 
          } else { // deeper entry
 
-            entry.date = p_date;
+            cluster.write(i, key, pack(old)); // refresh date
          }
 
          return;
@@ -129,57 +247,56 @@ void TT::store(Key key, const Info & info) {
       // evaluate replacement score
 
       int sc = 0;
-      sc = sc * Date_Size + p_age[entry.date];
-      sc = sc * 64 - entry.depth;
+      sc = sc * Date_Size + p_age[date(data)];
+      sc = sc * 64 - old.depth;
       assert(sc > -64);
 
       if (sc > bs) {
-         be = &entry;
+         bi = i;
+         bd = data;
          bs = sc;
       }
    }
 
    // "best" entry found
 
-   assert(be != nullptr);
-   Entry & entry = *be;
-   // assert(entry.lock != lock); // triggers in SMP
+   assert(bi >= 0);
+
+   if (stats != nullptr && bd != 0) {
 
-   // store
+      stats->evict += 1;
 
-   entry.lock = lock;
-   entry.date = p_date;
-   entry.move = int(info.move);
-   entry.score = info.score;
-   entry.flag = int(info.flag);
-   entry.depth = info.depth;
-   entry.eval = info.eval;
+      Info old;
+      unpack(bd, old);
+
+      if (date(bd) == p_date && old.depth > info.depth) stats->evict_deep += 1;
+   }
+
+   cluster.write(bi, key, pack(info));
 }
 
-bool TT::probe(Key key, Info & info) {
+template <class Cluster>
+bool Table<Cluster>::probe(Key key, Info & info, Stats * stats) {
 
    // init
 
+   if (stats != nullptr) stats->probe += 1;
+
    // probe
 
-   int    index = hash::index(key, p_mask);
-   uint32 lock  = hash::lock(key);
+   const Cluster & cluster = p_table[hash::index(key, p_size)];
 
-   for (int i = 0; i < Cluster_Size; i++) {
+   for (int i = 0; i < Cluster::Size; i++) {
 
-      assert(index + i < p_size);
-      const Entry & entry = p_table[index + i];
+      uint64 data = cluster.data(i);
 
-      if (entry.lock == lock) {
+      if (cluster.match(i, key, data)) {
 
          // found
 
-         info.move = Move(entry.move);
-         info.score = Score(entry.score);
-         info.flag = Flag(entry.flag);
-         info.depth = Depth(entry.depth);
-         info.eval = Score(entry.eval);
+         if (stats != nullptr) stats->hit += 1;
 
+         unpack(data, info);
          return true;
       }
    }
@@ -190,5 +307,170 @@ bool TT::probe(Key key, Info & info) {
    return false;
 }
 
+template <class Cluster>
+void Table<Cluster>::prefetch(Key key) const {
+   ml::prefetch(&p_table[hash::index(key, p_size)]); // whole cluster is one cache line
+}
+
+template <class Cluster>
+int Table<Cluster>::hashfull() const { // permille of sampled entries written in this search
+
+   int size = int(std::min(p_size, int64(Hashfull_Sample / Cluster::Size)));
+   if (size == 0) return 0;
+
+   int n = 0;
+
+   for (int i = 0; i < size; i++) {
+      for (int j = 0; j < Cluster::Size; j++) {
+         uint64 data = p_table[i].data(j);
+         if (data != 0 && date(data) == p_date) n++;
+      }
+   }
+
+   return n * 1000 / (size * Cluster::Size);
+}
+
+template <class Cluster>
+bool Table<Cluster>::save(const std::string & file) const {
+
+   assert(sizeof(File_Header) <= File_Header_Size);
+
+   File_Header header;
+   std::memset(&header, 0, sizeof(header));
+
+   std::memcpy(header.magic, File_Magic, sizeof(File_Magic));
+   header.version = File_Version;
+   header.cluster_size = sizeof(Cluster);
+   header.entries = Cluster::Size;
+   header.size = p_size;
+   header.key = uint64(hash::key(pos::Start));
+   header.date = p_date;
+
+   std::vector<char> block(File_Header_Size, 0);
+   std::memcpy(block.data(), &header, sizeof(header));
+
+   // write to a temporary file, as "file" may be the one we are mapping
+
+   std::string tmp = file + ".tmp";
+   std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+
+   out.write(block.data(), File_Header_Size);
+   out.write(reinterpret_cast<const char *>(p_table), bytes());
+   out.close();
+
+   if (!out) {
+      std::remove(tmp.c_str());
+      return false;
+   }
+
+   return std::rename(tmp.c_str(), file.c_str()) == 0;
+}
+
+template <class Cluster>
+bool Table<Cluster>::load(const std::string & file) {
+
+   int64 file_size;
+   void * p = ml::map_file(file, file_size);
+   if (p == nullptr) return false;
+
+   File_Header header;
+   if (file_size >= File_Header_Size) std::memcpy(&header, p, sizeof(header));
+
+   if (file_size < File_Header_Size
+    || std::memcmp(header.magic, File_Magic, sizeof(File_Magic)) != 0
+    || header.version != File_Version
+    || header.cluster_size != sizeof(Cluster)
+    || header.entries != Cluster::Size
+    || header.size < 1
+    || header.size > (int64(1) << 40) / int64(sizeof(Cluster))
+    || file_size != File_Header_Size + header.size * int64(sizeof(Cluster))
+    || header.key != uint64(hash::key(pos::Start))
+    || header.date < 0 || header.date >= Date_Size
+    ) {
+      ml::unmap_file(p, file_size);
+      return false;
+   }
+
+   free_table();
+
+   p_table = reinterpret_cast<Cluster *>(static_cast<char *>(p) + File_Header_Size);
+   p_pages = ml::Pages::File;
+
+   p_size = header.size;
+
+   set_date(header.date);
+   p_clean = false;
+
+   return true;
+}
+
+template <class Cluster>
+uint64 Table<Cluster>::pack(const Info & info) const {
+
+   uint64 data = 0;
+
+   data |= uint64(uint16(int(info.move) + 1)) << Move_Shift;
+   data |= uint64(uint16(info.score)) << Score_Shift;
+   data |= uint64(uint16(info.eval)) << Eval_Shift;
+   data |= uint64(info.depth - Depth_Min) << Depth_Shift;
+   data |= uint64(p_date) << Date_Shift;
+   data |= uint64(info.flag) << Flag_Shift;
+
+   return data;
+}
+
+template <class Cluster>
+void Table<Cluster>::unpack(uint64 data, Info & info) {
+
+   info.move  = Move(int(uint16(data >> Move_Shift)) - 1);
+   info.score = Score(int16(data >> Score_Shift));
+   info.eval  = Score(int16(data >> Eval_Shift));
+   info.depth = Depth(int(uint8(data >> Depth_Shift)) + Depth_Min);
+   info.flag  = Flag((data >> Flag_Shift) & 3);
+}
+
+template <class Cluster>
+int Table<Cluster>::date(uint64 data) {
+   return (data >> Date_Shift) & (Date_Size - 1);
 }
 
+void Stats::clear() {
+   probe = 0;
+   hit = 0;
+   cut = 0;
+   store = 0;
+   evict = 0;
+   evict_deep = 0;
+}
+
+void Stats::add(const Stats & stats) {
+   probe += stats.probe;
+   hit += stats.hit;
+   cut += stats.cut;
+   store += stats.store;
+   evict += stats.evict;
+   evict_deep += stats.evict_deep;
+}
+
+std::string Stats::to_string() const {
+
+   double hit_rate = (probe == 0) ? 0.0 : double(hit) / double(probe);
+   double cut_rate = (probe == 0) ? 0.0 : double(cut) / double(probe);
+
+   std::string s;
+   s += "probes " + std::to_string(probe);
+   s += " hits " + std::to_string(hit) + " (" + std::to_string(ml::round(hit_rate * 100.0)) + "%)";
+   s += " cutoffs " + std::to_string(cut) + " (" + std::to_string(ml::round(cut_rate * 100.0)) + "%)";
+   s += " stores " + std::to_string(store);
+   s += " evictions " + std::to_string(evict);
+   s += " deeper " + std::to_string(evict_deep);
+
+   return s;
+}
+
+// both layouts are always compiled
+
+template class Table<Cluster_4>;
+template class Table<Cluster_6>;
+
+}
@@ -4,11 +4,21 @@
 
 // includes
 
-#include <vector>
+#include <atomic>
+#include <string>
 
 #include "common.hpp"
 #include "libmy.hpp"
 
+// constants
+
+#ifdef TT_COMPACT // 6 entries per cache line instead of 4
+#  undef TT_COMPACT
+#  define TT_COMPACT TRUE
+#else
+#  define TT_COMPACT FALSE
+#endif
+
 namespace tt {
 
 // types
@@ -21,49 +31,120 @@ struct Info {
    Score eval;
 };
 
-class TT {
+struct Stats { // per thread, cheap enough to be always on
+   int64 probe;
+   int64 hit;
+   int64 cut;
+   int64 store;
+   int64 evict;      // other position overwritten
+   int64 evict_deep; // ... and it was from this search and deeper
 
-private :
+   void clear ();
+   void add   (const Stats & stats);
 
-   static const int Date_Size = 16;
+   std::string to_string () const;
+};
 
-   struct Entry { // 16 bytes
-      uint32 lock;
-      int16 move;
-      int16 score;
-      int16 eval;
-      uint16 pad_2; // #
-      int8 depth;
-      uint8 date;
-      uint8 flag;
-      uint8 pad_1; // #
+// clusters: one cache line of entries, each entry is a 64-bit data word plus a lock
+
+class alignas(64) Cluster_4 { // 4 x 16 bytes
+
+private :
+
+   struct Entry {
+      std::atomic<uint64> lock; // key ^ data, detects torn writes
+      std::atomic<uint64> data;
    };
 
-   std::vector<Entry> p_table;
+   Entry p_entry[4];
+
+public :
+
+   static const int Size = 4;
+
+   uint64 data  (int i) const { return p_entry[i].data.load(std::memory_order_relaxed); }
+   bool   match (int i, Key key, uint64 data) const;
+   void   write (int i, Key key, uint64 data);
+};
+
+class alignas(64) Cluster_6 { // 6 x 10 bytes + 4 bytes padding
+
+private :
+
+   std::atomic<uint64> p_data[6];
+   std::atomic<uint16> p_lock[6]; // 16 key bits ^ folded data
+   uint32 p_pad; // #
+
+public :
+
+   static const int Size = 6;
+
+   uint64 data  (int i) const { return p_data[i].load(std::memory_order_relaxed); }
+   bool   match (int i, Key key, uint64 data) const;
+   void   write (int i, Key key, uint64 data);
+
+private :
+
+   static uint16 lock (Key key, uint64 data);
+};
+
+template <class Cluster> class Table {
+
+private :
+
+   static const int Date_Size = 16;
+
+   Cluster * p_table;
+   ml::Pages p_pages;
 
-   int p_size;
-   int p_mask;
+   int64 p_size; // clusters
    int p_date;
    int p_age[Date_Size];
+   bool p_clean; // no search since last clear
 
 public :
 
-   TT ();
+   Table  ();
+   ~Table ();
 
-   void set_size (int size);
+   void set_size (int64 bytes);
 
    void clear    ();
    void inc_date ();
 
-   void store (Key key, const Info & info);
-   bool probe (Key key, Info & info);
+   void store (Key key, const Info & info, Stats * stats = nullptr);
+   bool probe (Key key, Info & info, Stats * stats = nullptr);
+
+   void prefetch (Key key) const;
+
+   int  hashfull () const;
+
+   bool save (const std::string & file) const;
+   bool load (const std::string & file);
+
+   ml::Pages pages () const { return p_pages; }
+   int64     bytes () const { return p_size * int64(sizeof(Cluster)); }
 
 private :
 
+   void free_table  ();
+   void clear_range (int id, int threads);
+
    void set_date (int date);
    int  age      (int date) const;
+
+   uint64 pack (const Info & info) const;
+
+   static void unpack (uint64 data, Info & info);
+   static int  date   (uint64 data);
 };
 
+#if TT_COMPACT
+typedef Table<Cluster_6> TT;
+#else
+typedef Table<Cluster_4> TT;
+#endif
+
 // variables
 
 extern TT G_TT; // MOVE ME?
@@ -0,0 +1,193 @@
+
+// includes
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+#include "bit.hpp"
+#include "common.hpp"
+#include "hash.hpp"
+#include "libmy.hpp"
+#include "math.hpp"
+#include "score.hpp"
+#include "tt.hpp"
+#include "var.hpp"
+
+// constants
+
+const int64 Table_Bytes { int64(1) << 20 }; // small, so that threads keep overwriting each other's clusters
+const int   Key_Size    { 1 << 17 };        // ~2 keys per entry
+
+// types
+
+struct Counts { // per thread
+   int64 store;
+   int64 probe;
+   int64 hit;
+   int64 torn; // hit, but not what was stored for this key
+};
+
+// variables
+
+static std::vector<Key> G_Key;
+static std::atomic<bool> G_Stop;
+
+// prototypes
+
+template <class Cluster> static bool stress (const char * name, int threads, double time);
+template <class Cluster> static void worker (tt::Table<Cluster> * table, int id, Counts * counts);
+
+static void init_keys (int64 clusters);
+
+static tt::Info key_info (Key key);
+static bool     same     (const tt::Info & a, const tt::Info & b);
+
+static uint64 next (uint64 & x);
+
+// functions
+
+int main(int argc, char * argv[]) { // ttstress [threads] [seconds]
+
+   int threads = (argc > 1) ? std::stoi(argv[1]) : 4;
+   double time = (argc > 2) ? std::stod(argv[2]) : 5.0;
+
+   math::init();
+   bit::init();
+   hash::init();
+   var::init();
+
+   var::update();
+
+   threads = math::clamp(threads, 1, 1024);
+
+   bool ok = true;
+
+   ok &= stress<tt::Cluster_4>("Cluster_4", threads, time);
+   ok &= stress<tt::Cluster_6>("Cluster_6", threads, time);
+
+   std::cout << (ok ? "all ok" : "FAILED") << std::endl;
+
+   return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+template <class Cluster>
+static bool stress(const char * name, int threads, double time) {
+
+   tt::Table<Cluster> table;
+   table.set_size(Table_Bytes);
+
+   init_keys(table.bytes() / 64);
+
+   std::vector<Counts> counts(threads, Counts { 0, 0, 0, 0 });
+   std::vector<std::thread> thread;
+
+   G_Stop = false;
+
+   for (int id = 0; id < threads; id++) {
+      thread.push_back(std::thread(worker<Cluster>, &table, id, &counts[id]));
+   }
+
+   std::this_thread::sleep_for(std::chrono::duration<double>(time));
+   G_Stop = true;
+
+   for (auto & t : thread) t.join();
+
+   Counts sum { 0, 0, 0, 0 };
+
+   for (const Counts & c : counts) {
+      sum.store += c.store;
+      sum.probe += c.probe;
+      sum.hit   += c.hit;
+      sum.torn  += c.torn;
+   }
+
+   std::cout << name << ": " << threads << " threads, " << time << " s, ";
+   std::cout << sum.store << " stores, " << sum.probe << " probes, " << sum.hit << " hits, " << sum.torn << " torn" << std::endl;
+
+   int64 allowed = (Cluster::Size == 6) ? sum.hit >> 16 : 0; // Cluster_6 checks only 16 bits, see Cluster_6::lock()
+   return sum.torn <= allowed;
+}
+
+template <class Cluster>
+static void worker(tt::Table<Cluster> * table, int id, Counts * counts) {
+
+   uint64 x = uint64(id) * 0x9E3779B97F4A7C15 + 1;
+
+   Counts c { 0, 0, 0, 0 };
+
+   while (!G_Stop) {
+
+      for (int n = 0; n < 1024; n++) { // between looks at the flag
+
+         uint64 r = next(x);
+         Key key = G_Key[r % Key_Size];
+
+         if ((r >> 32) & 1) {
+
+            table->store(key, key_info(key));
+            c.store += 1;
+
+         } else {
+
+            tt::Info info;
+            c.probe += 1;
+
+            if (table->probe(key, info)) {
+               c.hit += 1;
+               if (!same(info, key_info(key))) c.torn += 1;
+            }
+         }
+      }
+   }
+
+   *counts = c;
+}
+
+static void init_keys(int64 clusters) { // no two keys may pass each other's check, or a mismatch would not be a torn entry
+
+   std::unordered_set<uint64> seen; // index + 16 lock bits (all Cluster_6 checks)
+
+   G_Key.clear();
+
+   uint64 x = 1;
+
+   while (int(G_Key.size()) < Key_Size) {
+
+      Key key = Key(next(x));
+      uint64 id = (uint64(hash::index(key, clusters)) << 16) | uint16(hash::lock(key));
+
+      if (seen.insert(id).second) G_Key.push_back(key);
+   }
+}
+
+static tt::Info key_info(Key key) { // everything follows from the key, so any hit can be checked
+
+   uint64 k = uint64(key);
+
+   tt::Info info;
+   info.move  = Move(1 + (k >> 16) % 0x7FFE);
+   info.score = Score(int((k >> 32) & 0x3FFF) - 0x2000);
+   info.eval  = Score(int((k >> 46) & 0x3FFF) - 0x2000);
+   info.depth = Depth(1 + (k >> 8) % 60);
+   info.flag  = Flag((k >> 60) & 3);
+
+   return info;
+}
+
+static bool same(const tt::Info & a, const tt::Info & b) {
+   return a.move == b.move && a.score == b.score && a.eval == b.eval && a.depth == b.depth && a.flag == b.flag;
+}
+
+static uint64 next(uint64 & x) { // splitmix64
+   uint64 z = (x += 0x9E3779B97F4A7C15);
+   z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9;
+   z = (z ^ (z >> 27)) * 0x94D049BB133111EB;
+   return z ^ (z >> 31);
+}
+
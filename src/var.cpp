@@ -16,8 +16,14 @@ namespace var {
 
 bool Ponder;
 bool SMP;
+bool Lazy_SMP;
+bool Seed_History;
 int  Threads;
 int  Hash;
+bool Never_Clear_Hash;
+bool Hash_Stats;
+int  Pawn_Hash;
+int  MultiPV;
 bool Chess_960;
 
 static std::map<std::string, std::string> Var;
@@ -28,7 +34,14 @@ void init() {
 
    set("Ponder", "false");
    set("Threads", "1");
+   set("SMP Mode", "YBWC");
+   set("Seed History", "false");
    set("Hash", "64");
+   set("Hash File", "senpai.hash");
+   set("Never Clear Hash", "false");
+   set("Hash Stats", "false");
+   set("Pawn Hash", "1");
+   set("MultiPV", "1");
    set("UCI_Chess960", "false");
 
    update();
@@ -36,11 +49,17 @@ void init() {
 
 void update() {
 
-   Ponder    = get_bool("Ponder");
-   Threads   = get_int("Threads");
-   SMP       = Threads > 1;
-   Hash      = 1 << ml::log_2(get_int("Hash"));
-   Chess_960 = get_bool("UCI_Chess960");
+   Ponder           = get_bool("Ponder");
+   Threads          = get_int("Threads");
+   SMP              = Threads > 1;
+   Lazy_SMP         = get("SMP Mode") == "Lazy";
+   Seed_History     = get_bool("Seed History");
+   Hash             = get_int("Hash");
+   Never_Clear_Hash = get_bool("Never Clear Hash");
+   Hash_Stats       = get_bool("Hash Stats");
+   Pawn_Hash        = get_int("Pawn Hash");
+   MultiPV          = get_int("MultiPV");
+   Chess_960        = get_bool("UCI_Chess960");
 }
 
 std::string get(const std::string & name) {
@@ -14,8 +14,14 @@ namespace var {
 
 extern bool Ponder;
 extern bool SMP;
+extern bool Lazy_SMP;
+extern bool Seed_History;
 extern int  Threads;
 extern int  Hash;
+extern bool Never_Clear_Hash;
+extern bool Hash_Stats;
+extern int  Pawn_Hash;
+extern int  MultiPV;
 extern bool Chess_960;
 
 // functions